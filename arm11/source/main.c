@@ -32,6 +32,7 @@
 
 #include "system/sys.h"
 #include "system/event.h"
+#include "system/job.h"
 
 static const u8 brightness_lvls[] = {
 	0x10, 0x17, 0x1E, 0x25,
@@ -88,6 +89,91 @@ static u32 pxiRxUpdate(u32 *args)
 	return lo;
 }
 
+// handles the commands that can be either sent directly
+// or queued up, buffer is either the shared data buffer
+// or the scatter buffer given in the command descriptor
+static u32 pxiCmdHandler(u32 cmd, const u32 *args, void *buffer)
+{
+	switch(cmd) {
+		// takes in a single argument word and performs either an
+		// I2C read or write depending on the value of the top bit
+		case PXICMD_I2C_OP:
+		{
+			u32 devId, regAddr, size;
+
+			devId = (args[0] & 0xff);
+			regAddr = (args[0] >> 8) & 0xFF;
+			size = (args[0] >> 16) % SHMEM_BUFFER_SIZE;
+
+			if (args[0] & BIT(31))
+				return I2C_writeRegBuf(devId, regAddr, buffer, size);
+			return I2C_readRegBuf(devId, regAddr, buffer, size);
+		}
+
+		// checks whether the NVRAM chip is online (not doing any work)
+		case PXICMD_NVRAM_ONLINE:
+			return (NVRAM_Status() & NVRAM_SR_WIP) == 0;
+
+		// reads data from the NVRAM chip
+		case PXICMD_NVRAM_READ:
+			NVRAM_Read(args[0], buffer, args[1]);
+			return 0;
+
+		// sets the notification LED with the given color and period
+		case PXICMD_SET_NOTIFY_LED:
+			mcuSetStatusLED(args[0], args[1]);
+			return 0;
+
+		// sets the LCDs brightness (if FIXED_BRIGHTNESS is disabled)
+		case PXICMD_SET_BRIGHTNESS:
+		{
+			u32 oldbrightness = GFX_getBrightness();
+			#ifndef FIXED_BRIGHTNESS
+			s32 newbrightness = (s32)args[0];
+			if ((newbrightness > 0) && (newbrightness < 0x100)) {
+				GFX_setBrightness(newbrightness, newbrightness);
+				auto_brightness = false;
+			} else {
+				prev_bright_lvl = -1;
+				auto_brightness = true;
+			}
+			#endif
+			return oldbrightness;
+		}
+
+		// replies -1 on default
+		default:
+			return 0xFFFFFFFF;
+	}
+}
+
+// runs the next queued command, returns false if there was nothing to do
+static bool pxiQueueUpdate(void)
+{
+	u32 done = sharedMem.cmdDone;
+	SystemCmd *desc;
+	void *buffer;
+
+	if (done == sharedMem.cmdHead)
+		return false;
+
+	desc = &sharedMem.cmdRing[done % SHMEM_CMD_SLOTS];
+	buffer = desc->buf ? (void*)desc->buf : sharedMem.dataBuffer.b;
+
+	if (desc->buf)
+		ARM_InvDC_Range(buffer, desc->len);
+
+	desc->reply = pxiCmdHandler(desc->cmd, desc->args, buffer);
+
+	if (desc->buf) {
+		ARM_WbInvDC_Range(buffer, desc->len);
+		ARM_DSB();
+	}
+
+	sharedMem.cmdDone = done + 1;
+	return true;
+}
+
 void __attribute__((noreturn)) MainLoop(void)
 {
 	bool runPxiCmdProcessor = true;
@@ -133,9 +219,11 @@ void __attribute__((noreturn)) MainLoop(void)
 		pxiCmd = pxiRxUpdate(args);
 
 		switch(pxiCmd) {
-			// ignore args and just wait until the next event
+			// process any queued commands and pending
+			// jobs, otherwise just wait until the next event
 			case PXICMD_NONE:
-				ARM_WFI();
+				if (!pxiQueueUpdate() && !JOB_Process(sharedMem.jobRing))
+					ARM_WFI();
 				break;
 
 			// revert to legacy boot mode
@@ -149,61 +237,19 @@ void __attribute__((noreturn)) MainLoop(void)
 				pxiReply = (u32)&sharedMem;
 				break;
 
-			// takes in a single argument word and performs either an
-			// I2C read or write depending on the value of the top bit
-			case PXICMD_I2C_OP:
-			{
-				u32 devId, regAddr, size;
-
-				devId = (args[0] & 0xff);
-				regAddr = (args[0] >> 8) & 0xFF;
-				size = (args[0] >> 16) % SHMEM_BUFFER_SIZE;
-
-				if (args[0] & BIT(31)) {
-					pxiReply = I2C_writeRegBuf(devId, regAddr, sharedMem.dataBuffer.b, size);
-				} else {
-					pxiReply = I2C_readRegBuf(devId, regAddr, sharedMem.dataBuffer.b, size);
-				}
-				break;
-			}
-
-			// checks whether the NVRAM chip is online (not doing any work)
-			case PXICMD_NVRAM_ONLINE:
-				pxiReply = (NVRAM_Status() & NVRAM_SR_WIP) == 0;
-				break;
-
-			// reads data from the NVRAM chip
-			case PXICMD_NVRAM_READ:
-				NVRAM_Read(args[0], sharedMem.dataBuffer.w, args[1]);
-				pxiReply = 0;
+			// queues up the job in the given slot of the job ring
+			case PXICMD_JOB_SUBMIT:
+				pxiReply = JOB_Submit(sharedMem.jobRing, args[0]);
 				break;
 
-			// sets the notification LED with the given color and period
-			case PXICMD_SET_NOTIFY_LED:
-				mcuSetStatusLED(args[0], args[1]);
+			// only wakes us up, queued commands are
+			// picked up once there's nothing else to do
+			case PXICMD_CMDQ_KICK:
 				pxiReply = 0;
 				break;
 
-			// sets the LCDs brightness (if FIXED_BRIGHTNESS is disabled)
-			case PXICMD_SET_BRIGHTNESS:
-			{
-				pxiReply = GFX_getBrightness();
-				#ifndef FIXED_BRIGHTNESS
-				s32 newbrightness = (s32)args[0];
-				if ((newbrightness > 0) && (newbrightness < 0x100)) {
-					GFX_setBrightness(newbrightness, newbrightness);
-					auto_brightness = false;
-				} else {
-					prev_bright_lvl = -1;
-					auto_brightness = true;
-				}
-				#endif
-				break;
-			}
-
-			// replies -1 on default
 			default:
-				pxiReply = 0xFFFFFFFF;
+				pxiReply = pxiCmdHandler(pxiCmd, args, sharedMem.dataBuffer.b);
 				break;
 		}
 
@@ -0,0 +1,98 @@
+/*
+ *   This file is part of GodMode9
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common.h>
+#include <types.h>
+#include <arm.h>
+
+#include "system/job.h"
+
+// nibble-wise table, the full byte table
+// isn't worth the AXI WRAM it would take up
+static const u32 crc32_nibble_lut[16] = {
+	0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+	0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+	0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+	0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static u32 crc32Kernel(u32 crc, const u8 *data, u32 len)
+{
+	while(len--) {
+		crc ^= *(data++);
+		crc = (crc >> 4) ^ crc32_nibble_lut[crc & 0xF];
+		crc = (crc >> 4) ^ crc32_nibble_lut[crc & 0xF];
+	}
+	return crc;
+}
+
+u32 JOB_Submit(SystemJob *ring, u32 slot)
+{
+	SystemJob *job;
+
+	if (slot >= SHMEM_JOB_SLOTS)
+		return 0xFFFFFFFF;
+
+	job = &ring[slot];
+	if ((job->status != SHMEM_JOB_FREE) || (job->kernel >= SHMEM_KERNEL_COUNT))
+		return 0xFFFFFFFF;
+
+	// the source data was written back by the ARM9
+	// make sure no stale lines are left in our cache
+	ARM_InvDC_Range((void*)job->src, job->len);
+	ARM_DSB();
+
+	job->result = job->arg;
+	job->status = SHMEM_JOB_QUEUED;
+	return 0;
+}
+
+bool JOB_Process(SystemJob *ring)
+{
+	for (u32 i = 0; i < SHMEM_JOB_SLOTS; i++) {
+		SystemJob *job = &ring[i];
+		u32 status = job->status;
+		u32 blksz;
+
+		if ((status != SHMEM_JOB_QUEUED) && (status != SHMEM_JOB_RUNNING))
+			continue;
+
+		job->status = SHMEM_JOB_RUNNING;
+		blksz = min(job->len, JOB_CHUNK_SIZE);
+
+		switch(job->kernel) {
+			case SHMEM_KERNEL_CRC32:
+				job->result = crc32Kernel(job->result, (const u8*)job->src, blksz);
+				break;
+
+			default:
+				blksz = job->len;
+				break;
+		}
+
+		job->src += blksz;
+		job->len -= blksz;
+
+		if (!job->len)
+			job->status = SHMEM_JOB_DONE;
+
+		// one chunk per call, come back after checking for events
+		return true;
+	}
+
+	return false;
+}
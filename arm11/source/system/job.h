@@ -0,0 +1,33 @@
+/*
+ *   This file is part of GodMode9
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <types.h>
+#include <shmem.h>
+
+/*
+ offloaded jobs are processed from the idle path of the main loop,
+ at most JOB_CHUNK_SIZE bytes at a time so that VBlank and PXI
+ events are still serviced while a long job is running
+*/
+#define JOB_CHUNK_SIZE	(16UL << 10)
+
+u32 JOB_Submit(SystemJob *ring, u32 slot);
+
+// returns false if there was nothing to do
+bool JOB_Process(SystemJob *ring);
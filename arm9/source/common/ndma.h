@@ -0,0 +1,18 @@
+#pragma once
+
+#include "common.h"
+
+// see: https://www.3dbrew.org/wiki/NDMA_Registers
+#define NDMA_BASE                 (0x10002000)
+#define REG_NDMA_SRC(n)           (*(vu32*)(NDMA_BASE + 0x04 + ((n) * 0x1C)))
+#define REG_NDMA_DST(n)           (*(vu32*)(NDMA_BASE + 0x08 + ((n) * 0x1C)))
+#define REG_NDMA_TOTAL_CNT(n)     (*(vu32*)(NDMA_BASE + 0x0C + ((n) * 0x1C)))
+#define REG_NDMA_LOG_BLK_CNT(n)   (*(vu32*)(NDMA_BASE + 0x10 + ((n) * 0x1C)))
+#define REG_NDMA_INT_CNT(n)       (*(vu32*)(NDMA_BASE + 0x14 + ((n) * 0x1C)))
+#define REG_NDMA_CNT(n)           (*(vu32*)(NDMA_BASE + 0x1C + ((n) * 0x1C)))
+
+#define NDMA_DST_UPDATE_FIXED     (2u << 10)
+#define NDMA_SRC_UPDATE_FIXED     (2u << 13)
+#define NDMA_BURST_WORDS(n)       ((u32) __builtin_ctz(n) << 16)
+#define NDMA_STARTUP_SDMMC        (6u << 24) // SD/MMC controller at 0x10006000
+#define NDMA_ENABLE               (1u << 31)
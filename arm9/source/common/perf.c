@@ -0,0 +1,86 @@
+#include "perf.h"
+#ifdef MONITOR_HEAP
+#include "mymalloc.h"
+#endif
+
+PerfCounters perf_counters = { 0 };
+
+static const char* const perf_aes_mode_names[PERF_AES_MODES] = {
+    "CCM dec", "CCM enc", "CTR", "CTR (3)", "CBC dec", "CBC enc", "ECB dec", "ECB enc"
+};
+
+static const char* const perf_op_names[PERF_OP_COUNT] = {
+    "copy", "verify", "install"
+};
+
+void PerfOpEnd(u32 op, u64 start) {
+    if (op >= PERF_OP_COUNT) return;
+    PerfOpTimer* timer = &(perf_counters.ops[op]);
+    u64 ticks = timer_ticks(start);
+    timer->count++;
+    timer->ticks += ticks;
+    if (ticks > timer->max_ticks) timer->max_ticks = ticks;
+}
+
+#ifdef MONITOR_HEAP
+static u64 perf_allocs_base = 0;
+static u64 perf_alloc_bytes_base = 0;
+#endif
+
+void PerfReset(void) {
+    memset(&perf_counters, 0, sizeof(PerfCounters));
+    #ifdef MONITOR_HEAP
+    perf_allocs_base = mem_alloc_count();
+    perf_alloc_bytes_base = mem_alloc_bytes();
+    #endif
+}
+
+void PerfReport(char* report) {
+    // snapshot first, the counters keep running while we format
+    PerfCounters pc;
+    memcpy(&pc, &perf_counters, sizeof(PerfCounters));
+    #ifdef MONITOR_HEAP
+    pc.allocs = mem_alloc_count() - perf_allocs_base;
+    pc.alloc_bytes = mem_alloc_bytes() - perf_alloc_bytes_base;
+    #endif
+
+    char* ptr = report;
+    char* end = report + PERF_REPORT_SIZE - 1;
+    #define PERF_PRINT(...) ptr += snprintf(ptr, end - ptr, __VA_ARGS__); if (ptr > end) ptr = end
+
+    PERF_PRINT("# disk I/O (ops / KiB / ms)\n");
+    for (u32 i = 0; i < PERF_DRIVES; i++) {
+        PerfIoCounter* rd = &(pc.disk_read[i]);
+        PerfIoCounter* wr = &(pc.disk_write[i]);
+        if (!rd->ops && !wr->ops) continue;
+        PERF_PRINT("pdrv%lu read : %llu / %llu / %llu\n", i, rd->ops, rd->bytes >> 10, rd->ticks / (TICKS_PER_SEC/1000));
+        PERF_PRINT("pdrv%lu write: %llu / %llu / %llu\n", i, wr->ops, wr->bytes >> 10, wr->ticks / (TICKS_PER_SEC/1000));
+    }
+
+    PERF_PRINT("\n# AES blocks\n");
+    for (u32 i = 0; i < PERF_AES_MODES; i++) {
+        if (!pc.aes_blocks[i]) continue;
+        PERF_PRINT("%-7.7s: %llu\n", perf_aes_mode_names[i], pc.aes_blocks[i]);
+    }
+    PERF_PRINT("\n# AES keys\nkeyY   : %llu\nskipped: %llu\nslotsel: %llu\n",
+        pc.aes_keyy_writes, pc.aes_keyy_skips, pc.aes_keyslot_switches);
+
+    PERF_PRINT("\n# SHA\nbytes  : %llu\n", pc.sha_bytes);
+    PERF_PRINT("\n# FatFs window\nhits   : %llu\nmisses : %llu\n", pc.fatfs_win_hits, pc.fatfs_win_misses);
+    #ifdef MONITOR_HEAP
+    PERF_PRINT("\n# heap\nallocs : %llu\nbytes  : %llu\n", pc.allocs, pc.alloc_bytes);
+    #endif
+
+    PERF_PRINT("\n# operations (count / total ms / max ms)\n");
+    for (u32 i = 0; i < PERF_OP_COUNT; i++) {
+        PerfOpTimer* op = &(pc.ops[i]);
+        PERF_PRINT("%-7.7s: %llu / %llu / %llu\n", perf_op_names[i], op->count,
+            op->ticks / (TICKS_PER_SEC/1000), op->max_ticks / (TICKS_PER_SEC/1000));
+    }
+
+    #undef PERF_PRINT
+
+    // pad to a fixed size, the virtual file doesn't change size
+    memset(ptr, ' ', end - ptr);
+    *end = '\n';
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "common.h"
+#include "timer.h"
+
+#define PERF_DRIVES         10 // physical FatFs drives (see FF_VOLUMES)
+#define PERF_AES_MODES      8  // see AES_CNT mode bits
+#define PERF_REPORT_SIZE    0x1000
+
+enum {
+    PERF_OP_COPY = 0,
+    PERF_OP_VERIFY,
+    PERF_OP_INSTALL,
+    PERF_OP_COUNT
+};
+
+typedef struct {
+    u64 ops;
+    u64 bytes;
+    u64 ticks;
+} PerfIoCounter;
+
+typedef struct {
+    u64 count;
+    u64 ticks;
+    u64 max_ticks;
+} PerfOpTimer;
+
+typedef struct {
+    PerfIoCounter disk_read[PERF_DRIVES];
+    PerfIoCounter disk_write[PERF_DRIVES];
+    u64 aes_blocks[PERF_AES_MODES];
+    u64 aes_keyy_writes; // key Y (re)programming
+    u64 aes_keyy_skips; // ... avoided by aes_use_context()
+    u64 aes_keyslot_switches;
+    u64 sha_bytes;
+    u64 fatfs_win_hits;
+    u64 fatfs_win_misses;
+    u64 allocs; // only with MONITOR_HEAP
+    u64 alloc_bytes;
+    PerfOpTimer ops[PERF_OP_COUNT];
+} PerfCounters;
+
+extern PerfCounters perf_counters;
+
+// simple counters, cheap enough for the hot paths
+#define PERF_ADD(field, n)  (perf_counters.field += (n))
+
+static inline void PerfDiskIo(u32 pdrv, bool write, u32 count, u64 start) {
+    if (pdrv >= PERF_DRIVES) return;
+    PerfIoCounter* io = write ? &(perf_counters.disk_write[pdrv]) : &(perf_counters.disk_read[pdrv]);
+    io->ops++;
+    io->bytes += (u64) count * 0x200;
+    io->ticks += timer_ticks(start);
+}
+
+static inline void PerfAes(u32 mode, u32 blocks) {
+    perf_counters.aes_blocks[(mode >> 27) & (PERF_AES_MODES-1)] += blocks;
+}
+
+void PerfOpEnd(u32 op, u64 start);
+void PerfReset(void);
+
+// writes a text snapshot of all counters, padded to PERF_REPORT_SIZE
+void PerfReport(char* report);
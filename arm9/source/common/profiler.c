@@ -0,0 +1,103 @@
+#include "profiler.h"
+#include "timer.h"
+#include "vff.h"
+
+#include <arm.h>
+
+// see: https://www.3dbrew.org/wiki/IRQ_Registers
+#define REG_IRQ_IE  ((vu32*)0x10001000)
+#define REG_IRQ_IF  ((vu32*)0x10001004)
+#define IRQ_TIMER0  BIT(8)
+
+extern u32 __text_s, __text_e;
+
+static u32* prof_buckets = NULL;
+static u32 prof_n_buckets = 0;
+static vu32 prof_n_samples = 0;
+static vu32 prof_n_outside = 0;
+
+#ifdef PROFILER
+static u32 prof_irq_ie = 0; // IE as left by the loader, restored on stop
+static bool prof_running = false;
+
+bool PROF_Start(void) {
+    u32 text_start = (u32) &__text_s;
+    u32 text_end = (u32) &__text_e;
+
+    if (!prof_buckets) {
+        prof_n_buckets = ((text_end - text_start) >> PROF_BUCKET_SHIFT) + 1;
+        prof_buckets = (u32*) malloc(prof_n_buckets * sizeof(u32));
+        if (!prof_buckets) return false;
+        memset(prof_buckets, 0, prof_n_buckets * sizeof(u32));
+        prof_n_samples = prof_n_outside = 0;
+    }
+
+    // timer 0 keeps on counting as before, it just raises an IRQ on overflow
+    timer_start();
+    *REG_IRQ_IF = IRQ_TIMER0;
+    if (!prof_running) prof_irq_ie = *REG_IRQ_IE;
+    *REG_IRQ_IE = IRQ_TIMER0; // anything else would end up in the fatal IRQ path
+    prof_running = true;
+    *TIMER_CNT0 |= TIMER_IRQ;
+    ARM_EnableInterrupts();
+    return true;
+}
+
+void PROF_Stop(void) {
+    ARM_DisableInterrupts();
+    *TIMER_CNT0 &= ~TIMER_IRQ;
+    *REG_IRQ_IF = IRQ_TIMER0;
+    if (prof_running) *REG_IRQ_IE = prof_irq_ie;
+    prof_running = false;
+}
+
+u32 PROF_Dump(void) {
+    ProfileHeader hdr;
+    FIL file;
+    UINT bw;
+    u32 ret = 0;
+
+    if (!prof_buckets) return 1;
+
+    // don't sample our own file writes
+    PROF_Stop();
+
+    memcpy(hdr.magic, PROF_MAGIC, 4);
+    hdr.version = PROF_VERSION;
+    hdr.text_start = (u32) &__text_s;
+    hdr.text_end = (u32) &__text_e;
+    hdr.bucket_shift = PROF_BUCKET_SHIFT;
+    hdr.n_buckets = prof_n_buckets;
+    hdr.n_samples = prof_n_samples;
+    hdr.n_outside = prof_n_outside;
+    hdr.sample_ticks = 0x10000;
+    hdr.ticks_per_sec = TICKS_PER_SEC;
+
+    fvx_rmkdir(OUTPUT_PATH);
+    if (fvx_open(&file, PROF_FILE, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK)
+        return 1;
+    if ((fvx_write(&file, &hdr, sizeof(ProfileHeader), &bw) != FR_OK) || (bw != sizeof(ProfileHeader)) ||
+        (fvx_write(&file, prof_buckets, prof_n_buckets * sizeof(u32), &bw) != FR_OK) ||
+        (bw != prof_n_buckets * sizeof(u32)))
+        ret = 1;
+    fvx_close(&file);
+
+    // start over with a clean histogram
+    free(prof_buckets);
+    prof_buckets = NULL;
+    return ret;
+}
+#endif
+
+bool PROF_Sample(u32 pc) {
+    if (!(*REG_IRQ_IF & IRQ_TIMER0) || !prof_buckets)
+        return false;
+    *REG_IRQ_IF = IRQ_TIMER0;
+
+    u32 text_start = (u32) &__text_s;
+    u32 bucket = (pc - text_start) >> PROF_BUCKET_SHIFT;
+    if ((pc >= text_start) && (bucket < prof_n_buckets)) prof_buckets[bucket]++;
+    else prof_n_outside++;
+    prof_n_samples++;
+    return true;
+}
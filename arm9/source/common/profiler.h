@@ -0,0 +1,33 @@
+#pragma once
+
+#include "common.h"
+
+// sampling profiler, only available in builds with PROFILER=1
+// samples are taken on timer 0 overflow (every 65536 ticks, ~1kHz)
+
+#define PROF_MAGIC          "GM9P"
+#define PROF_VERSION        1
+#define PROF_BUCKET_SHIFT   4 // 16 byte buckets
+#define PROF_FILE           OUTPUT_PATH "/profile.bin"
+
+typedef struct {
+    char magic[4];
+    u32 version;
+    u32 text_start;
+    u32 text_end;
+    u32 bucket_shift;
+    u32 n_buckets;
+    u32 n_samples; // including the ones outside of .text
+    u32 n_outside;
+    u32 sample_ticks;
+    u32 ticks_per_sec;
+} PACKED_STRUCT ProfileHeader;
+
+bool PROF_Start(void);
+void PROF_Stop(void);
+
+// writes the histogram to PROF_FILE, 0 on success
+u32 PROF_Dump(void);
+
+// called from the IRQ handler, false if the IRQ wasn't ours
+bool PROF_Sample(u32 pc);
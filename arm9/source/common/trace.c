@@ -0,0 +1,68 @@
+#include "trace.h"
+#include "timer.h"
+#include "vff.h"
+
+static TraceRecord* trace_ring = NULL;
+static u64 trace_count = 0;
+static bool trace_busy = false;
+
+void TraceEvent(u32 event, u32 arg0, u32 arg1, const char* text) {
+    // the ring lives in FCRAM, ARM9 RAM is way too tight for it
+    if (trace_busy) return;
+    if (!trace_ring) {
+        trace_ring = (TraceRecord*) malloc(TRACE_RECORDS * sizeof(TraceRecord));
+        if (!trace_ring) return;
+    }
+
+    TraceRecord* rec = &(trace_ring[trace_count++ % TRACE_RECORDS]);
+    rec->ticks = timer_start();
+    rec->event = event;
+    rec->args[0] = arg0;
+    rec->args[1] = arg1;
+    if (text) {
+        u32 len = strnlen(text, 256);
+        if (len >= TRACE_TEXT_LEN) text += len - (TRACE_TEXT_LEN - 1);
+        strncpy(rec->text, text, TRACE_TEXT_LEN);
+    } else memset(rec->text, 0, TRACE_TEXT_LEN);
+}
+
+u32 TraceFlush(void) {
+    TraceHeader hdr;
+    FIL file;
+    UINT bw;
+    u32 ret = 0;
+
+    if (!trace_ring) return 1;
+    TraceEvent(TRACE_EV_FLUSH, (u32) trace_count, (u32) (trace_count >> 32), NULL);
+
+    // don't trace our own file operations
+    trace_busy = true;
+
+    u32 n_records = min(trace_count, TRACE_RECORDS);
+    u32 first = (trace_count > TRACE_RECORDS) ? (trace_count % TRACE_RECORDS) : 0;
+    memcpy(hdr.magic, TRACE_MAGIC, 4);
+    hdr.version = TRACE_VERSION;
+    hdr.record_size = sizeof(TraceRecord);
+    hdr.n_records = n_records;
+    hdr.ticks_per_sec = TICKS_PER_SEC;
+    hdr.n_events = trace_count;
+
+    fvx_rmkdir(OUTPUT_PATH);
+    if (fvx_open(&file, TRACE_FILE, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
+        trace_busy = false;
+        return 1;
+    }
+
+    // oldest records first, the ring may have wrapped around
+    u32 n_tail = min(n_records, TRACE_RECORDS - first);
+    if ((fvx_write(&file, &hdr, sizeof(TraceHeader), &bw) != FR_OK) || (bw != sizeof(TraceHeader)) ||
+        (fvx_write(&file, trace_ring + first, n_tail * sizeof(TraceRecord), &bw) != FR_OK) ||
+        (bw != n_tail * sizeof(TraceRecord)) ||
+        (fvx_write(&file, trace_ring, (n_records - n_tail) * sizeof(TraceRecord), &bw) != FR_OK) ||
+        (bw != (n_records - n_tail) * sizeof(TraceRecord)))
+        ret = 1;
+
+    fvx_close(&file);
+    trace_busy = false;
+    return ret;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "common.h"
+
+#define TRACE_MAGIC         "GM9T"
+#define TRACE_VERSION       1
+#define TRACE_RECORDS       4096 // ring buffer size, oldest records get overwritten
+#define TRACE_TEXT_LEN      20
+#define TRACE_FILE          OUTPUT_PATH "/trace.bin"
+
+// event IDs, keep in sync with utils/tracedec.py
+enum {
+    TRACE_EV_NONE = 0,
+    TRACE_EV_FS_OPEN,       // mode, result, path
+    TRACE_EV_FS_RENAME,     // result, -, new path
+    TRACE_EV_FS_UNLINK,     // result, -, path
+    TRACE_EV_FS_MKDIR,      // result, -, path
+    TRACE_EV_AES_KEYX,      // keyslot
+    TRACE_EV_AES_KEYY,      // keyslot
+    TRACE_EV_AES_KEY,       // keyslot
+    TRACE_EV_AES_USE,       // keyslot
+    TRACE_EV_MOUNT,         // drive #, result
+    TRACE_EV_UNMOUNT,       // drive type mask
+    TRACE_EV_IMG_MOUNT,     // image type (low / high word), path
+    TRACE_EV_SCRIPT_START,  // command ID, flags, command name
+    TRACE_EV_SCRIPT_END,    // command ID, result, command name
+    TRACE_EV_FLUSH,         // total events
+    TRACE_EV_COUNT
+};
+
+typedef struct {
+    u64 ticks;
+    u32 event;
+    u32 args[2];
+    char text[TRACE_TEXT_LEN]; // tail end of the string, if any
+} PACKED_STRUCT TraceRecord;
+
+typedef struct {
+    char magic[4];
+    u32 version;
+    u32 record_size;
+    u32 n_records; // oldest first
+    u64 ticks_per_sec;
+    u64 n_events; // total, including overwritten ones
+} PACKED_STRUCT TraceHeader;
+
+void TraceEvent(u32 event, u32 arg0, u32 arg1, const char* text);
+
+// writes the ring buffer to TRACE_FILE, 0 on success
+u32 TraceFlush(void);
@@ -1,10 +1,21 @@
 /* original version by megazig */
 #include "aes.h"
+#include "perf.h"
+#include "trace.h"
+
+// last key Y written to each keyslot, cleared by key X / normal key writes
+// (keys written to the registers outside of this file: aes_invalidate_keyy())
+static uint8_t keyy_active[0x40][16] __attribute__((aligned(4)));
+static uint64_t keyy_known = 0;
+
+#define KEYY_KNOWN(slot)    (keyy_known & ((uint64_t) 1 << (slot)))
 
 // FIXME some things make assumptions about alignemnts!
 // setup_aeskey? and set_ctr do not anymore (c) d0k3
 void setup_aeskeyX(uint8_t keyslot, const void* keyx)
 {
+    TraceEvent(TRACE_EV_AES_KEYX, keyslot, 0, NULL);
+    keyy_known &= ~((uint64_t) 1 << (keyslot & 0x3F));
     uint32_t _keyx[4] __attribute__((aligned(32)));
     for (uint32_t i = 0; i < 16u; i++)
         ((uint8_t*)_keyx)[i] = ((uint8_t*)keyx)[i];
@@ -28,9 +39,12 @@ void setup_aeskeyX(uint8_t keyslot, const void* keyx)
 
 void setup_aeskeyY(uint8_t keyslot, const void* keyy)
 {
+    TraceEvent(TRACE_EV_AES_KEYY, keyslot, 0, NULL);
+    PERF_ADD(aes_keyy_writes, 1);
     uint32_t _keyy[4] __attribute__((aligned(32)));
     for (uint32_t i = 0; i < 16u; i++)
-        ((uint8_t*)_keyy)[i] = ((uint8_t*)keyy)[i];
+        ((uint8_t*)_keyy)[i] = keyy_active[keyslot & 0x3F][i] = ((uint8_t*)keyy)[i];
+    keyy_known |= ((uint64_t) 1 << (keyslot & 0x3F));
 
     *REG_AESCNT = (*REG_AESCNT) | AES_CNT_INPUT_ENDIAN | AES_CNT_INPUT_ORDER;
     *REG_AESKEYCNT = (*REG_AESKEYCNT >> 6 << 6) | keyslot | 0x80;
@@ -51,6 +65,8 @@ void setup_aeskeyY(uint8_t keyslot, const void* keyy)
 
 void setup_aeskey(uint8_t keyslot, const void* key)
 {
+    TraceEvent(TRACE_EV_AES_KEY, keyslot, 0, NULL);
+    keyy_known &= ~((uint64_t) 1 << (keyslot & 0x3F));
     uint32_t _key[4] __attribute__((aligned(32)));
     for (uint32_t i = 0; i < 16u; i++)
         ((uint8_t*)_key)[i] = ((uint8_t*)key)[i];
@@ -74,12 +90,45 @@ void setup_aeskey(uint8_t keyslot, const void* key)
 
 void use_aeskey(uint32_t keyno)
 {
+    static uint32_t keyno_prev = (uint32_t) -1;
     if (keyno > 0x3F)
         return;
+    if (keyno != keyno_prev) { // NAND access selects keys all the time
+        TraceEvent(TRACE_EV_AES_USE, keyno, 0, NULL);
+        PERF_ADD(aes_keyslot_switches, 1);
+    }
+    keyno_prev = keyno;
     *REG_AESKEYSEL = keyno;
     *REG_AESCNT    = *REG_AESCNT | 0x04000000; /* mystery bit */
 }
 
+void aes_init_context(AesContext* ctx, uint32_t keyslot, const void* keyy)
+{
+    ctx->keyslot = keyslot;
+    ctx->has_keyy = (keyy != NULL);
+    for (uint32_t i = 0; i < 16u; i++)
+        ctx->keyy[i] = keyy ? ((const uint8_t*)keyy)[i] : 0;
+}
+
+void aes_use_context(const AesContext* ctx)
+{
+    if (ctx->keyslot > 0x3F)
+        return;
+    if (ctx->has_keyy) {
+        bool reprogram = !KEYY_KNOWN(ctx->keyslot);
+        for (uint32_t i = 0; !reprogram && (i < 16u); i++)
+            reprogram = (keyy_active[ctx->keyslot][i] != ctx->keyy[i]);
+        if (reprogram) setup_aeskeyY(ctx->keyslot, ctx->keyy);
+        else PERF_ADD(aes_keyy_skips, 1);
+    }
+    use_aeskey(ctx->keyslot);
+}
+
+void aes_invalidate_keyy(uint32_t keyslot)
+{
+    keyy_known &= ~((uint64_t) 1 << (keyslot & 0x3F));
+}
+
 void set_ctr(void* iv)
 {
     uint32_t _iv[4] __attribute__((aligned(32)));
@@ -275,6 +324,7 @@ void aes_decrypt(void* inbuf, void* outbuf, size_t size, uint32_t mode)
     uint8_t *out = outbuf;
     size_t block_count = size;
     size_t blocks;
+    PerfAes(mode, size);
     while (block_count != 0)
     {
         blocks = (block_count >= 0xFFFF) ? 0xFFFF : block_count;
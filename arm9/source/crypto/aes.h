@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -46,10 +47,21 @@ extern "C" {
 #define AES_CNT_ECB_DECRYPT_MODE (AES_ECB_DECRYPT_MODE | AES_CNT_INPUT_ORDER | AES_CNT_OUTPUT_ORDER | AES_CNT_INPUT_ENDIAN | AES_CNT_OUTPUT_ENDIAN)
 #define AES_CNT_ECB_ENCRYPT_MODE (AES_ECB_ENCRYPT_MODE | AES_CNT_INPUT_ORDER | AES_CNT_OUTPUT_ORDER | AES_CNT_INPUT_ENDIAN | AES_CNT_OUTPUT_ENDIAN)
 
+// AES context: keyslot and key Y of one crypto stream
+// aes_use_context() only reprograms the key Y if it changed since the last time
+typedef struct {
+    uint32_t keyslot;
+    bool has_keyy; // otherwise keyslot is used as is
+    uint8_t keyy[16] __attribute__((aligned(4)));
+} AesContext;
+
 void setup_aeskeyX(uint8_t keyslot, const void* keyx);
 void setup_aeskeyY(uint8_t keyslot, const void* keyy);
 void setup_aeskey(uint8_t keyslot, const void* keyy);
 void use_aeskey(uint32_t keyno);
+void aes_init_context(AesContext* ctx, uint32_t keyslot, const void* keyy);
+void aes_use_context(const AesContext* ctx);
+void aes_invalidate_keyy(uint32_t keyslot);
 void set_ctr(void* iv);
 void add_ctr(void* ctr, uint32_t carry);
 void subtract_ctr(void* ctr, uint32_t carry);
@@ -5,6 +5,7 @@
 #include "common.h"
 #include "crc32.h"
 #include "vff.h"
+#include "job.h"
 
 u32 crc32_adjust(u32 crc32, u8 input) {
     static const u32 crc32_table[256] = {
@@ -65,8 +66,9 @@ u32 crc32_calculate(u32 crc32, const u8* data, u32 length) {
 u32 crc32_calculate_from_file(const char* fileName, u32 offset, u32 length) {
     FIL inputFile;
     u32 crc32 = ~0;
-    u32 bufsiz = min(STD_BUFFER_SIZE, length);
-    u8* buffer = (u8*) malloc(bufsiz);
+    u32 bufsiz = min(STD_BUFFER_SIZE / 2, length);
+    u8* buffer = (u8*) malloc(bufsiz * 2);
+    int job = -1;
     if (!buffer) return false;
     if (fvx_open(&inputFile, fileName, FA_READ) != FR_OK) {
         free(buffer);
@@ -74,15 +76,22 @@ u32 crc32_calculate_from_file(const char* fileName, u32 offset, u32 length) {
     }
     fvx_lseek(&inputFile, offset);
 
+    // double buffered, the ARM11 checksums one half while the next one is read
     bool ret = true;
-    for (u64 pos = 0; (pos < length) && ret; pos += bufsiz) {
+    for (u64 pos = 0, i = 0; (pos < length) && ret; pos += bufsiz, i++) {
+        u8* block = buffer + ((i & 1) ? bufsiz : 0);
         UINT read_bytes = min(bufsiz, length - pos);
         UINT bytes_read = read_bytes;
-        if ((fvx_read(&inputFile, buffer, read_bytes, &bytes_read) != FR_OK) ||
+        if ((fvx_read(&inputFile, block, read_bytes, &bytes_read) != FR_OK) ||
             (read_bytes != bytes_read))
             ret = false;
-        if (ret) crc32 = crc32_calculate(crc32, buffer, read_bytes);
+        if (job >= 0) crc32 = JOB_Wait(job);
+        job = -1;
+        if (!ret) break;
+        job = JOB_Submit(SHMEM_KERNEL_CRC32, block, read_bytes, crc32);
+        if (job < 0) crc32 = crc32_calculate(crc32, block, read_bytes);
     }
+    if (job >= 0) crc32 = JOB_Wait(job);
 
     fvx_close(&inputFile);
     free(buffer);
@@ -1,5 +1,6 @@
 #include "sha.h"
 #include "mmio.h"
+#include "perf.h"
 
 typedef struct
 {
@@ -15,6 +16,7 @@ void sha_init(u32 mode)
 void sha_update(const void* src, u32 size)
 {
     const u32* src32 = (const u32*)src;
+    PERF_ADD(sha_bytes, size);
 
     while(size >= 0x40) {
         while(*REG_SHACNT & 1);
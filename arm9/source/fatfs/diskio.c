@@ -14,6 +14,7 @@
 #include "nand.h"
 #include "sdmmc.h"
 #include "rtc.h"
+#include "perf.h"
 
 
 #define FREE_MIN_SECTORS 0x2000 // minimum sectors for the free drive to appear (4MB)
@@ -87,6 +88,17 @@ DWORD get_fattime( void ) {
 
 
 
+/*-----------------------------------------------------------------------*/
+/* Count sector window hits / misses                                     */
+/*-----------------------------------------------------------------------*/
+
+void disk_window_stat( BYTE hit ) {
+    if (hit) PERF_ADD(fatfs_win_hits, 1);
+    else PERF_ADD(fatfs_win_misses, 1);
+}
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Get Drive Status                                                      */
 /*-----------------------------------------------------------------------*/
@@ -168,6 +180,7 @@ DRESULT disk_read (
 )
 {
     BYTE type = PART_TYPE(pdrv);
+    u64 perf = timer_start();
 
     if (type == TYPE_NONE) {
         return RES_PARERR;
@@ -186,6 +199,7 @@ DRESULT disk_read (
             return RES_ERROR;
     }
 
+    PerfDiskIo(pdrv, false, count, perf);
 	return RES_OK;
 }
 
@@ -205,6 +219,7 @@ DRESULT disk_write (
 )
 {
     BYTE type = PART_TYPE(pdrv);
+    u64 perf = timer_start();
 
     if (type == TYPE_NONE) {
         return RES_PARERR;
@@ -223,6 +238,7 @@ DRESULT disk_write (
             return RES_ERROR; // unstubbed!
     }
 
+    PerfDiskIo(pdrv, true, count, perf);
 	return RES_OK;
 }
 #endif
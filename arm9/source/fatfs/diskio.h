@@ -31,6 +31,7 @@ typedef enum {
 
 
 DWORD get_fattime( void ); // not a disk control function, but fits here
+void disk_window_stat( BYTE hit ); // same as above, sector window statistics
 DSTATUS disk_initialize (BYTE pdrv);
 DSTATUS disk_status (BYTE pdrv);
 DRESULT disk_read (BYTE pdrv, BYTE* buff, DWORD sector, UINT count);
@@ -1099,6 +1099,7 @@ static FRESULT move_window (	/* Returns FR_OK or FR_DISK_ERR */
 	FRESULT res = FR_OK;
 
 
+	disk_window_stat(sect == fs->winsect);
 	if (sect != fs->winsect) {	/* Window offset changed? */
 #if !FF_FS_READONLY
 		res = sync_window(fs);		/* Flush the window */
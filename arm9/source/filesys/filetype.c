@@ -10,8 +10,54 @@
 #include "scripting.h"
 #include "png.h"
 #include "ui.h" // only for font file detection
+#include "fsdrive.h"
+#include "vff.h"
 
-u64 IdentifyFileType(const char* path) {
+#define FTYPE_HEADER_SIZE   0x2C0 // minimum required size
+#define FTYPE_CACHE_SIZE    256
+
+typedef struct {
+    u32 hash; // case insensitive path hash, 0 -> unused
+    u32 hash2; // second, independent path hash against collisions
+    u32 fdatetime;
+    u64 fsize;
+    u64 type;
+} FileTypeCacheEntry;
+
+static FileTypeCacheEntry ftype_cache[FTYPE_CACHE_SIZE] = { 0 };
+static u32 ftype_cache_next = 0;
+
+static u32 GetFileTypeCacheHash(const char* path, u32* hash2) {
+    u32 hash = 0x811C9DC5; // FNV-1a
+    *hash2 = 0; // sdbm
+    for (; *path; path++) {
+        u8 c = (u8) tolower(*path);
+        hash ^= c;
+        hash *= 0x01000193;
+        *hash2 = c + (*hash2 << 6) + (*hash2 << 16) - *hash2;
+    }
+    return hash ? hash : 1;
+}
+
+static FileTypeCacheEntry* FindFileTypeCacheEntry(u32 hash, u32 hash2) {
+    for (u32 i = 0; i < FTYPE_CACHE_SIZE; i++)
+        if ((ftype_cache[i].hash == hash) && (ftype_cache[i].hash2 == hash2)) return &(ftype_cache[i]);
+    return NULL;
+}
+
+void FlushFileTypeCache(void) {
+    memset(ftype_cache, 0, sizeof(ftype_cache));
+    ftype_cache_next = 0;
+}
+
+void InvalidateFileTypeCache(const char* path) {
+    u32 hash2;
+    u32 hash = GetFileTypeCacheHash(path, &hash2);
+    FileTypeCacheEntry* entry = FindFileTypeCacheEntry(hash, hash2);
+    if (entry) entry->hash = 0;
+}
+
+static u64 IdentifyFileTypeHeader(const char* path, u8* header, size_t fsize, bool* cacheable) {
     static const u8 romfs_magic[] = { ROMFS_MAGIC };
     static const u8 diff_magic[] = { DIFF_MAGIC };
     static const u8 disa_magic[] = { DISA_MAGIC };
@@ -20,25 +66,17 @@ u64 IdentifyFileType(const char* path) {
     static const u8 threedsx_magic[] = { THREEDSX_EXT_MAGIC };
     static const u8 png_magic[] = { PNG_MAGIC };
 
-    if (!path) return 0; // safety
-    u8 ALIGN(32) header[0x2C0]; // minimum required size
     void* data = (void*) header;
-    size_t fsize = FileGetSize(path);
     char* fname = strrchr(path, '/');
     char* ext = (fname) ? strrchr(++fname, '.') : NULL;
     u32 id = 0;
 
-    // block crappy "._" files from getting recognized as filetype
     if (!fname) return 0;
-    if (strncmp(fname, "._", 2) == 0) return 0;
-
     if (ext) {
         ext++;
     } else {
         ext = "";
     }
-    if (FileGetData(path, header, 0x2C0, 0) < min(0x2C0, fsize)) return 0;
-    if (!fsize) return 0;
 
     if (fsize >= 0x200) {
         if (ValidateNandNcsdHeader((NandNcsdHeader*) data) == 0) {
@@ -174,6 +212,7 @@ u64 IdentifyFileType(const char* path) {
             (strncmp(hdr.magic, TAD_HEADER_MAGIC, strlen(TAD_HEADER_MAGIC)) == 0))
             return GAME_TAD;
     } else if ((strnlen(fname, 16) == 8) && (sscanf(fname, "%08lx", &id) == 1)) {
+        *cacheable = false; // depends on other files in the same folder
         char path_cdn[256];
         char* name_cdn = path_cdn + (fname - path);
         strncpy(path_cdn, path, 256);
@@ -188,3 +227,66 @@ u64 IdentifyFileType(const char* path) {
 
     return 0;
 }
+
+static u64 IdentifyFileTypeStat(const char* path, FILINFO* fno) {
+    u8 ALIGN(32) header[FTYPE_HEADER_SIZE];
+    const char* fname = strrchr(path, '/');
+    size_t fsize = fno->fsize;
+
+    // block crappy "._" files from getting recognized as filetype
+    if (!fname || (strncmp(fname + 1, "._", 2) == 0)) return 0;
+    if (!fsize || (fno->fattrib & AM_DIR)) return 0;
+
+    // only files on real FAT drives can be cached, virtual files have no timestamps
+    u32 drvtype = DriveType(path);
+    bool cacheable = (drvtype & DRV_FAT) && !(drvtype & DRV_VIRTUAL);
+    u32 fdatetime = ((u32) fno->fdate << 16) | fno->ftime;
+    u32 hash = 0;
+    u32 hash2 = 0;
+
+    if (cacheable) {
+        hash = GetFileTypeCacheHash(path, &hash2);
+        FileTypeCacheEntry* entry = FindFileTypeCacheEntry(hash, hash2);
+        if (entry && (entry->fsize == fsize) && (entry->fdatetime == fdatetime))
+            return entry->type;
+        else if (entry) entry->hash = 0; // outdated
+    }
+
+    if (FileGetData(path, header, FTYPE_HEADER_SIZE, 0) < min(FTYPE_HEADER_SIZE, fsize)) return 0;
+    u64 type = IdentifyFileTypeHeader(path, header, fsize, &cacheable);
+
+    if (cacheable) {
+        FileTypeCacheEntry* entry = &(ftype_cache[ftype_cache_next]);
+        ftype_cache_next = (ftype_cache_next + 1) % FTYPE_CACHE_SIZE;
+        entry->hash = hash;
+        entry->hash2 = hash2;
+        entry->fdatetime = fdatetime;
+        entry->fsize = fsize;
+        entry->type = type;
+    }
+
+    return type;
+}
+
+u64 IdentifyFileType(const char* path) {
+    FILINFO fno;
+    if (!path) return 0; // safety
+    if (fvx_stat(path, &fno) != FR_OK) return 0;
+    return IdentifyFileTypeStat(path, &fno);
+}
+
+u32 IdentifyDirContents(DirStruct* contents, u64* types, bool marked_only) {
+    u32 n_identified = 0;
+    for (u32 i = 0; i < contents->n_entries; i++) {
+        DirEntry* entry = &(contents->entry[i]);
+        FILINFO fno;
+        u64 type = 0;
+        if ((entry->type == T_FILE) && (!marked_only || entry->marked) &&
+            (fvx_stat(entry->path, &fno) == FR_OK)) {
+            type = IdentifyFileTypeStat(entry->path, &fno);
+            n_identified++;
+        }
+        if (types) types[i] = type;
+    }
+    return n_identified;
+}
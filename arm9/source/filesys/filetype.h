@@ -1,6 +1,7 @@
 #pragma once
 
 #include "common.h"
+#include "fsdir.h"
 
 #define IMG_FAT     (1ULL<<0)
 #define IMG_NAND    (1ULL<<1)
@@ -59,6 +60,7 @@
 #define FTYPE_TIKINSTALL(tp)    (tp&(GAME_TICKET))
 #define FTYPE_CIFINSTALL(tp)    (tp&(BIN_CIFNSH))
 #define FTYPE_TIKDUMP(tp)       (tp&(GAME_TIE))
+#define FTYPE_TIKBULKDUMP(tp)   (tp&(SYS_TICKDB))
 #define FTYPE_CXIDUMP(tp)       (tp&(GAME_TMD|GAME_TIE))
 #define FTYPE_UNINSTALL(tp)     (tp&(GAME_TIE))
 #define FTYPE_TIKBUILD(tp)      (tp&(GAME_TICKET|SYS_TICKDB|BIN_TIKDB))
@@ -86,3 +88,6 @@
 #define FTYPE_AGBSAVE(tp)       (tp&(SYS_AGBSAVE))
 
 u64 IdentifyFileType(const char* path);
+u32 IdentifyDirContents(DirStruct* contents, u64* types, bool marked_only);
+void InvalidateFileTypeCache(const char* path);
+void FlushFileTypeCache(void);
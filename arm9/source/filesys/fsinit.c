@@ -3,7 +3,9 @@
 #include "virtual.h"
 #include "sddata.h"
 #include "image.h"
+#include "filetype.h"
 #include "ff.h"
+#include "trace.h"
 
 // FATFS filesystem objects (x10)
 static FATFS fs[NORM_FS];
@@ -13,6 +15,7 @@ static bool fs_mounted[NORM_FS] = { false };
 
 bool InitSDCardFS() {
     fs_mounted[0] = (f_mount(fs, "0:", 1) == FR_OK);
+    TraceEvent(TRACE_EV_MOUNT, 0, fs_mounted[0], NULL);
     return fs_mounted[0];
 }
 
@@ -33,6 +36,7 @@ bool InitExtFS() {
             fs_mounted[i] = (f_mount(fs + i, fsname, 1) == FR_OK);
             ramdrv_ready = true;
         }
+        TraceEvent(TRACE_EV_MOUNT, i, fs_mounted[i], NULL);
     }
     SetupNandSdDrive("A:", "0:", "1:/private/movable.sed", 0);
     SetupNandSdDrive("B:", "0:", "4:/private/movable.sed", 1);
@@ -47,12 +51,15 @@ bool InitImgFS(const char* path) {
         snprintf(fsname, sizeof(fsname), "%lu:", drv_i);
         if (!(DriveType(fsname)&DRV_IMAGE)) break;
     }
+    // drop cached file types, image drive contents change
+    FlushFileTypeCache();
     // deinit virtual filesystem
     DeinitVirtualImageDrive();
     // deinit image filesystem
     DismountDriveType(DRV_IMAGE);
     // (re)mount image, done if path == NULL
     u64 type = MountImage(path);
+    TraceEvent(TRACE_EV_IMG_MOUNT, (u32) type, (u32) (type >> 32), path);
     InitVirtualImageDrive();
     if ((type&IMG_NAND) && (drv_i < NORM_FS)) drv_i = NORM_FS;
     else if ((type&IMG_FAT) && (drv_i < NORM_FS - IMGN_FS + 1)) drv_i = NORM_FS - IMGN_FS + 1;
@@ -83,6 +90,8 @@ void DeinitSDCardFS() {
 }
 
 void DismountDriveType(u32 type) { // careful with this - no safety checks
+    TraceEvent(TRACE_EV_UNMOUNT, type, 0, NULL);
+    FlushFileTypeCache();
     if (type & DriveType(GetMountPath()))
         InitImgFS(NULL); // image is mounted from type -> unmount image drive, too
     if (type & DRV_SDCARD) {
@@ -7,6 +7,7 @@
 #include "virtual.h"
 #include "image.h"
 #include "sha.h"
+#include "perf.h"
 #include "sdmmc.h"
 #include "ff.h"
 #include "ui.h"
@@ -678,9 +679,11 @@ bool PathMoveCopy(const char* dest, const char* orig, u32* flags, bool move) {
         }
 
         // actual move / copy operation
+        u64 perf = timer_start();
         bool same_drv = (strncasecmp(lorig, ldest, 2) == 0);
         bool res = PathMoveCopyRec(ldest, lorig, flags, move && same_drv, buffer, STD_BUFFER_SIZE);
         if (move && res && (!flags || !(*flags&SKIP_CUR))) PathDelete(lorig);
+        PerfOpEnd(PERF_OP_COPY, perf);
 
         free(buffer);
         return res;
@@ -717,9 +720,11 @@ bool PathMoveCopy(const char* dest, const char* orig, u32* flags, bool move) {
         }
 
         // actual virtual copy operation
+        u64 perf = timer_start();
         if (force_unmount) DismountDriveType(DriveType(ldest)&(DRV_SYSNAND|DRV_EMUNAND|DRV_IMAGE));
         bool res = PathMoveCopyRec(ldest, lorig, flags, false, buffer, STD_BUFFER_SIZE);
         if (force_unmount) InitExtFS();
+        PerfOpEnd(PERF_OP_COPY, perf);
 
         free(buffer);
         return res;
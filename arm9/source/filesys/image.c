@@ -9,12 +9,17 @@ static char mount_path[256] = { 0 };
 
 static bool fix_cmac = false;
 
+// readahead cache for small reads (header parsing, CBC IVs, virtual dir setup)
+#define IMAGE_CACHE_SIZE    0x4000
+#define IMAGE_CACHE_MAXREAD 0x1000
 
-int ReadImageBytes(void* buffer, u64 offset, u64 count) {
+static u8* cache_buffer = NULL;
+static u64 cache_offset = 0;
+static u64 cache_size = 0;
+
+static int ReadImageBytesDirect(void* buffer, u64 offset, u64 count) {
     UINT bytes_read;
     UINT ret;
-    if (!count) return -1;
-    if (!mount_state) return FR_INVALID_OBJECT;
     if (fvx_tell(&mount_file) != offset) {
         if (fvx_size(&mount_file) < offset) return -1;
         fvx_lseek(&mount_file, offset);
@@ -23,11 +28,38 @@ int ReadImageBytes(void* buffer, u64 offset, u64 count) {
     return (ret != 0) ? (int) ret : (bytes_read != count) ? -1 : 0;
 }
 
+static bool ReadImageBytesCached(void* buffer, u64 offset, u64 count) {
+    if ((offset < cache_offset) || (offset + count > cache_offset + cache_size)) {
+        u64 mount_size = fvx_size(&mount_file);
+        cache_size = 0;
+        if (!cache_buffer && !(cache_buffer = (u8*) malloc(IMAGE_CACHE_SIZE))) return false;
+        cache_offset = offset & ~(u64) 0x1FF;
+        if (cache_offset >= mount_size) return false;
+        u64 size = min(IMAGE_CACHE_SIZE, mount_size - cache_offset);
+        if (ReadImageBytesDirect(cache_buffer, cache_offset, size) != 0) return false;
+        cache_size = size;
+        if (offset + count > cache_offset + cache_size) return false; // crosses end of file
+    }
+    memcpy(buffer, cache_buffer + (offset - cache_offset), count);
+    return true;
+}
+
+
+int ReadImageBytes(void* buffer, u64 offset, u64 count) {
+    if (!count) return -1;
+    if (!mount_state) return FR_INVALID_OBJECT;
+    if ((count <= IMAGE_CACHE_MAXREAD) && ReadImageBytesCached(buffer, offset, count))
+        return 0;
+    return ReadImageBytesDirect(buffer, offset, count);
+}
+
 int WriteImageBytes(const void* buffer, u64 offset, u64 count) {
     UINT bytes_written;
     UINT ret;
     if (!count) return -1;
     if (!mount_state) return FR_INVALID_OBJECT;
+    if ((offset < cache_offset + cache_size) && (offset + count > cache_offset))
+        cache_size = 0; // overlaps cached data
     if (fvx_tell(&mount_file) != offset)
         fvx_lseek(&mount_file, offset);
     ret = fvx_write(&mount_file, buffer, count, &bytes_written);
@@ -66,6 +98,9 @@ u64 MountImage(const char* path) {
         fix_cmac = false;
         mount_state = 0;
         *mount_path = 0;
+        if (cache_buffer) free(cache_buffer);
+        cache_buffer = NULL;
+        cache_size = 0;
     }
     u64 type = (path) ? IdentifyFileType(path) : 0;
     if (!type) return 0;
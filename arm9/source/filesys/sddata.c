@@ -10,8 +10,8 @@
 typedef struct {
     FIL* fptr;
     u8 ctr[16];
-    u8 keyy[16];
-} PACKED_STRUCT FilCryptInfo;
+    AesContext aes; // keyslot 0x34 + key Y
+} FilCryptInfo;
 
 static FilCryptInfo filcrypt[NUM_FILCRYPTINFO] = { 0 };
 
@@ -169,7 +169,7 @@ FRESULT fx_open (FIL* fp, const TCHAR* path, BYTE mode) {
                 info->ctr[i] = sha256sum[i] ^ sha256sum[i+16];
         }
         // copy over key, FIL pointer
-        memcpy(info->keyy, sd_keyy[num], 16);
+        aes_init_context(&(info->aes), 0x34, sd_keyy[num]);
         info->fptr = fp;
     }
 
@@ -181,8 +181,7 @@ FRESULT fx_read (FIL* fp, void* buff, UINT btr, UINT* br) {
     FSIZE_t off = f_tell(fp);
     FRESULT res = f_read(fp, buff, btr, br);
     if (info && info->fptr) {
-        setup_aeskeyY(0x34, info->keyy);
-        use_aeskey(0x34);
+        aes_use_context(&(info->aes));
         if (memcmp(info->ctr, DSIWARE_MAGIC, 16) == 0) fx_decrypt_dsiware(fp, buff, off, btr);
         else ctr_decrypt_byte(buff, buff, btr, off, AES_CNT_CTRNAND_MODE, info->ctr);
     }
@@ -199,8 +198,7 @@ FRESULT fx_write (FIL* fp, const void* buff, UINT btw, UINT* bw) {
         void* crypt_buff = (void*) malloc(min(btw, STD_BUFFER_SIZE));
         if (!crypt_buff) return FR_DENIED;
 
-        setup_aeskeyY(0x34, info->keyy);
-        use_aeskey(0x34);
+        aes_use_context(&(info->aes));
         *bw = 0;
         for (UINT p = 0; (p < btw) && (res == FR_OK); p += STD_BUFFER_SIZE) {
             UINT pcount = min(STD_BUFFER_SIZE, (btw - p));
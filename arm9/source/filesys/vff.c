@@ -1,6 +1,8 @@
 #include "virtual.h"
 #include "ffconf.h"
 #include "vff.h"
+#include "filetype.h"
+#include "trace.h"
 
 #if FF_USE_LFN != 0
 #define _MAX_FN_LEN (FF_MAX_LFN)
@@ -25,7 +27,11 @@ FRESULT fvx_open (FIL* fp, const TCHAR* path, BYTE mode) {
         return FR_OK;
     }
     #endif
-    return fx_open ( fp, path, mode );
+    if (mode & (FA_WRITE|FA_CREATE_ALWAYS|FA_CREATE_NEW))
+        InvalidateFileTypeCache(path);
+    FRESULT res = fx_open ( fp, path, mode );
+    TraceEvent(TRACE_EV_FS_OPEN, mode, res, path);
+    return res;
 }
 
 FRESULT fvx_read (FIL* fp, void* buff, UINT btr, UINT* br) {
@@ -96,7 +102,11 @@ FRESULT fvx_stat (const TCHAR* path, FILINFO* fno) {
 
 FRESULT fvx_rename (const TCHAR* path_old, const TCHAR* path_new) {
     if ((GetVirtualSource(path_old)) || CheckAliasDrive(path_old)) return FR_DENIED;
-    return f_rename( path_old, path_new );
+    InvalidateFileTypeCache(path_old);
+    InvalidateFileTypeCache(path_new);
+    FRESULT res = f_rename( path_old, path_new );
+    TraceEvent(TRACE_EV_FS_RENAME, res, 0, path_new);
+    return res;
 }
 
 FRESULT fvx_unlink (const TCHAR* path) {
@@ -105,12 +115,17 @@ FRESULT fvx_unlink (const TCHAR* path) {
         if (!GetVirtualFile(&vfile, path, FA_READ)) return FR_NO_PATH;
         if (DeleteVirtualFile(&vfile) != 0) return FR_DENIED;
         return FR_OK;
-    } else return fa_unlink( path );
+    }
+    FRESULT res = fa_unlink( path );
+    TraceEvent(TRACE_EV_FS_UNLINK, res, 0, path);
+    return res;
 }
 
 FRESULT fvx_mkdir (const TCHAR* path) {
     if (GetVirtualSource(path)) return FR_DENIED;
-    return fa_mkdir( path );
+    FRESULT res = fa_mkdir( path );
+    TraceEvent(TRACE_EV_FS_MKDIR, res, 0, path);
+    return res;
 }
 
 FRESULT fvx_opendir (DIR* dp, const TCHAR* path) {
@@ -77,10 +77,34 @@ typedef struct {
     Ticket ticket;
 } __attribute__((packed, aligned(4))) TicketEntry;
 
+// in-memory copies of the BDRI tables (DET, FET, FHT, FAT) for batch operations
+typedef struct {
+    UINT offset;
+    UINT size;
+    u8* data;
+    bool dirty;
+} BDRITable;
+
+#define BDRI_N_TABLES 4
+
 static FIL* bdrifp;
+static BDRITable bdri_tables[BDRI_N_TABLES] = { 0 };
+
+static BDRITable* GetBDRITable(UINT ofs, UINT size) {
+    for (u32 i = 0; i < BDRI_N_TABLES; i++) {
+        BDRITable* table = &(bdri_tables[i]);
+        if (table->data && (ofs >= table->offset) && (ofs + size <= table->offset + table->size))
+            return table;
+    }
+    return NULL;
+}
 
 static FRESULT BDRIRead(UINT ofs, UINT btr, void* buf) {
-    if (bdrifp) {
+    BDRITable* table = GetBDRITable(ofs, btr);
+    if (table) {
+        memcpy(buf, table->data + (ofs - table->offset), btr);
+        return FR_OK;
+    } else if (bdrifp) {
         FRESULT res;
         UINT br;
         if ((fvx_tell(bdrifp) != ofs) &&
@@ -92,7 +116,12 @@ static FRESULT BDRIRead(UINT ofs, UINT btr, void* buf) {
 }
 
 static FRESULT BDRIWrite(UINT ofs, UINT btw, const void* buf) {
-    if (bdrifp) {
+    BDRITable* table = GetBDRITable(ofs, btw);
+    if (table) {
+        memcpy(table->data + (ofs - table->offset), buf, btw);
+        table->dirty = true;
+        return FR_OK;
+    } else if (bdrifp) {
         FRESULT res;
         UINT bw;
         if ((fvx_tell(bdrifp) != ofs) &&
@@ -103,6 +132,51 @@ static FRESULT BDRIWrite(UINT ofs, UINT btw, const void* buf) {
     } else return FR_DENIED;
 }
 
+static u32 FlushBDRITables(bool write_back) {
+    u32 ret = 0;
+    for (u32 i = 0; i < BDRI_N_TABLES; i++) {
+        BDRITable table = bdri_tables[i];
+        memset(&(bdri_tables[i]), 0, sizeof(BDRITable)); // detach first, so the write goes to the file
+        if (!table.data) continue;
+        if (write_back && table.dirty && (BDRIWrite(table.offset, table.size, table.data) != FR_OK))
+            ret = 1;
+        free(table.data);
+    }
+    return ret;
+}
+
+static u32 LoadBDRITables(const BDRIFsHeader* fs_header, const u32 fs_header_offset) {
+    const u32 data_offset = fs_header_offset + fs_header->data_offset;
+    const UINT offsets[BDRI_N_TABLES] = {
+        data_offset + fs_header->det_start_block * fs_header->data_block_size,
+        data_offset + fs_header->fet_start_block * fs_header->data_block_size,
+        fs_header_offset + fs_header->fht_offset,
+        fs_header_offset + fs_header->fat_offset
+    };
+    const UINT sizes[BDRI_N_TABLES] = {
+        fs_header->det_block_count * fs_header->data_block_size,
+        fs_header->fet_block_count * fs_header->data_block_size,
+        fs_header->fht_bucket_count * sizeof(u32),
+        (fs_header->fat_entry_count + 1) * FAT_ENTRY_SIZE
+    };
+
+    FlushBDRITables(false);
+    for (u32 i = 0; i < BDRI_N_TABLES; i++) {
+        u8* data = (u8*) malloc(sizes[i]);
+        if (!data || (BDRIRead(offsets[i], sizes[i], data) != FR_OK)) {
+            free(data);
+            FlushBDRITables(false);
+            return 1;
+        }
+        bdri_tables[i].offset = offsets[i];
+        bdri_tables[i].size = sizes[i];
+        bdri_tables[i].data = data;
+        bdri_tables[i].dirty = false;
+    }
+
+    return 0;
+}
+
 bool CheckDBMagic(const u8* pre_header, bool tickdb) {
     const TitleDBPreHeader* title = (TitleDBPreHeader*) pre_header;
     const TickDBPreHeader* tick = (TickDBPreHeader*) pre_header;
@@ -160,44 +234,16 @@ static u32 GetBDRIEntrySize(const BDRIFsHeader* fs_header, const u32 fs_header_o
     return 0;
 }
 
-static u32 ReadBDRIEntry(const BDRIFsHeader* fs_header, const u32 fs_header_offset, const u8* title_id, u8* entry, const u32 expected_size) {
-    if ((fs_header->info_offset != 0x20) || (fs_header->fat_entry_count != fs_header->data_block_count)) // Could be more thorough
-        return 1;
-
+static u32 ReadBDRIFileData(const BDRIFsHeader* fs_header, const u32 fs_header_offset, const TdbFileEntry* file_entry, u8* entry) {
     const u32 data_offset = fs_header_offset + fs_header->data_offset;
-    const u32 fet_offset = data_offset + fs_header->fet_start_block * fs_header->data_block_size;
-    const u32 fht_offset = fs_header_offset + fs_header->fht_offset;
     const u32 fat_offset = fs_header_offset + fs_header->fat_offset;
 
-    u32 index = 0;
-    TdbFileEntry file_entry;
-    u64 tid_be = getbe64(title_id);
-    u8* title_id_be = (u8*) &tid_be;
-    const u32 hash_bucket = GetHashBucket(title_id_be, 1, fs_header->fht_bucket_count);
-
-    if (BDRIRead(fht_offset + hash_bucket * sizeof(u32), sizeof(u32), &(file_entry.hash_bucket_next_index)) != FR_OK)
-        return 1;
-
-    // Find the file entry for the tid specified, fail if it doesn't exist
-    do {
-        if (file_entry.hash_bucket_next_index == 0)
-            return 1;
-
-        index = file_entry.hash_bucket_next_index;
-
-        if (BDRIRead(fet_offset + index * sizeof(TdbFileEntry), sizeof(TdbFileEntry), &file_entry) != FR_OK)
-            return 1;
-    } while (memcmp(title_id_be, file_entry.title_id, 8) != 0);
-
-    if (expected_size && (file_entry.size != expected_size))
-        return 1;
-
-    index = file_entry.start_block_index + 1; // FAT entry index
+    u32 index = file_entry->start_block_index + 1; // FAT entry index
 
     u32 bytes_read = 0;
     u32 fat_entry[2];
 
-    while (bytes_read < file_entry.size) { // Read the full entry, walking the FAT node chain
+    while (bytes_read < file_entry->size) { // Read the full entry, walking the FAT node chain
         u32 read_start = index - 1; // Data region block index
         u32 read_count = 0;
 
@@ -223,7 +269,7 @@ static u32 ReadBDRIEntry(const BDRIFsHeader* fs_header, const u32 fs_header_offs
 
         index = next_index;
 
-        u32 btr = min(file_entry.size - bytes_read, read_count * fs_header->data_block_size);
+        u32 btr = min(file_entry->size - bytes_read, read_count * fs_header->data_block_size);
         if (entry && (BDRIRead(data_offset + read_start * fs_header->data_block_size, btr, entry + bytes_read) != FR_OK))
             return 1;
 
@@ -233,6 +279,40 @@ static u32 ReadBDRIEntry(const BDRIFsHeader* fs_header, const u32 fs_header_offs
     return 0;
 }
 
+static u32 ReadBDRIEntry(const BDRIFsHeader* fs_header, const u32 fs_header_offset, const u8* title_id, u8* entry, const u32 expected_size) {
+    if ((fs_header->info_offset != 0x20) || (fs_header->fat_entry_count != fs_header->data_block_count)) // Could be more thorough
+        return 1;
+
+    const u32 data_offset = fs_header_offset + fs_header->data_offset;
+    const u32 fet_offset = data_offset + fs_header->fet_start_block * fs_header->data_block_size;
+    const u32 fht_offset = fs_header_offset + fs_header->fht_offset;
+
+    u32 index = 0;
+    TdbFileEntry file_entry;
+    u64 tid_be = getbe64(title_id);
+    u8* title_id_be = (u8*) &tid_be;
+    const u32 hash_bucket = GetHashBucket(title_id_be, 1, fs_header->fht_bucket_count);
+
+    if (BDRIRead(fht_offset + hash_bucket * sizeof(u32), sizeof(u32), &(file_entry.hash_bucket_next_index)) != FR_OK)
+        return 1;
+
+    // Find the file entry for the tid specified, fail if it doesn't exist
+    do {
+        if (file_entry.hash_bucket_next_index == 0)
+            return 1;
+
+        index = file_entry.hash_bucket_next_index;
+
+        if (BDRIRead(fet_offset + index * sizeof(TdbFileEntry), sizeof(TdbFileEntry), &file_entry) != FR_OK)
+            return 1;
+    } while (memcmp(title_id_be, file_entry.title_id, 8) != 0);
+
+    if (expected_size && (file_entry.size != expected_size))
+        return 1;
+
+    return ReadBDRIFileData(fs_header, fs_header_offset, &file_entry, entry);
+}
+
 static u32 RemoveBDRIEntry(const BDRIFsHeader* fs_header, const u32 fs_header_offset, const u8* title_id) {
     if ((fs_header->info_offset != 0x20) || (fs_header->fat_entry_count != fs_header->data_block_count)) // Could be more thorough
         return 1;
@@ -336,6 +416,19 @@ static u32 RemoveBDRIEntry(const BDRIFsHeader* fs_header, const u32 fs_header_of
     return 0;
 }
 
+static u32 RemoveBDRIEntries(const BDRIFsHeader* fs_header, const u32 fs_header_offset, const u8* title_ids, u32 n_title_ids, bool* removed) {
+    // all changes go to the in-memory tables, which are written back once
+    if (LoadBDRITables(fs_header, fs_header_offset) != 0)
+        return 1;
+
+    for (u32 i = 0; i < n_title_ids; i++) {
+        bool res = (RemoveBDRIEntry(fs_header, fs_header_offset, title_ids + (i * 8)) == 0);
+        if (removed) removed[i] = res;
+    }
+
+    return FlushBDRITables(true);
+}
+
 static u32 AddBDRIEntry(const BDRIFsHeader* fs_header, const u32 fs_header_offset, const u8* title_id, const u8* entry, const u32 size, bool replace) {
     if ((fs_header->info_offset != 0x20) || (fs_header->fat_entry_count != fs_header->data_block_count)) // Could be more thorough
         return 1;
@@ -620,6 +713,60 @@ static u32 ListBDRIEntryTitleIDs(const BDRIFsHeader* fs_header, const u32 fs_hea
     return 0;
 }
 
+static u32 ReadAllBDRIEntries(const BDRIFsHeader* fs_header, const u32 fs_header_offset,
+    u32 (*callback)(const u8* title_id, u8* entry, u32 size, void* userdata), void* userdata) {
+    if ((fs_header->info_offset != 0x20) || (fs_header->fat_entry_count != fs_header->data_block_count))
+        return 1;
+
+    const u32 data_offset = fs_header_offset + fs_header->data_offset;
+    const u32 det_offset = data_offset + fs_header->det_start_block * fs_header->data_block_size;
+    const u32 fet_offset = data_offset + fs_header->fet_start_block * fs_header->data_block_size;
+
+    TdbFileEntry file_entry;
+    u8* entry = NULL;
+    u32 entry_alloc = 0;
+    u32 num_entries = 0;
+    u32 ret = 0;
+
+    // Walk the file entry list once, no hash lookups (entry buffer is reused)
+    if (BDRIRead(det_offset + 0x2C, sizeof(u32), &(file_entry.next_sibling_index)) != FR_OK)
+        return 1;
+
+    while (file_entry.next_sibling_index != 0) {
+        // a corrupted (cyclic or out of range) sibling chain must not hang us
+        if ((file_entry.next_sibling_index > fs_header->max_file_count) ||
+            (num_entries++ >= fs_header->max_file_count)) {
+            ret = 1;
+            break;
+        }
+
+        if (BDRIRead(fet_offset + file_entry.next_sibling_index * sizeof(TdbFileEntry), sizeof(TdbFileEntry), &file_entry) != FR_OK) {
+            ret = 1;
+            break;
+        }
+
+        if (file_entry.size > entry_alloc) {
+            u8* entry_new = (u8*) realloc(entry, file_entry.size);
+            if (!entry_new) {
+                ret = 1;
+                break;
+            }
+            entry = entry_new;
+            entry_alloc = file_entry.size;
+        }
+
+        u64 tid_be = getbe64(file_entry.title_id);
+        if ((ReadBDRIFileData(fs_header, fs_header_offset, &file_entry, entry) != 0) ||
+            (callback((u8*) &tid_be, entry, file_entry.size, userdata) != 0)) {
+            ret = 1;
+            break;
+        }
+    }
+
+    free(entry);
+    return ret;
+}
+
 u32 GetNumTitleInfoEntries(const char* path) {
     FIL file;
     TitleDBPreHeader pre_header;
@@ -779,6 +926,45 @@ u32 ReadTicketFromDB(const char* path, const u8* title_id, Ticket** ticket) {
     return 0;
 }
 
+typedef struct {
+    u32 (*callback)(Ticket* ticket, void* userdata);
+    void* userdata;
+} TicketDBWalk;
+
+static u32 ReadTicketEntryCallback(const u8* title_id, u8* entry, u32 size, void* userdata) {
+    (void) title_id;
+    TicketDBWalk* walk = (TicketDBWalk*) userdata;
+    TicketEntry* te = (TicketEntry*) (void*) entry;
+    if ((size < sizeof(TicketEntry) + 0x14) || (te->ticket_size != GetTicketSize(&te->ticket)) ||
+        (te->ticket_size > size - 8))
+        return 0; // skip broken entries
+    return walk->callback(&te->ticket, walk->userdata);
+}
+
+u32 ReadAllTicketsFromDB(const char* path, u32 (*callback)(Ticket* ticket, void* userdata), void* userdata) {
+    FIL file;
+    TickDBPreHeader pre_header;
+    TicketDBWalk walk = { callback, userdata };
+
+    if (fvx_open(&file, path, FA_READ | FA_OPEN_EXISTING) != FR_OK)
+        return 1;
+
+    bdrifp = &file;
+
+    if ((BDRIRead(0, sizeof(TickDBPreHeader), &pre_header) != FR_OK) ||
+        !CheckDBMagic((u8*) &pre_header, true) ||
+        (ReadAllBDRIEntries(&(pre_header.fs_header), sizeof(TickDBPreHeader) - sizeof(BDRIFsHeader),
+            ReadTicketEntryCallback, &walk) != 0)) {
+        fvx_close(bdrifp);
+        bdrifp = NULL;
+        return 1;
+    }
+
+    fvx_close(bdrifp);
+    bdrifp = NULL;
+    return 0;
+}
+
 u32 RemoveTitleInfoEntryFromDB(const char* path, const u8* title_id) {
     FIL file;
     TitleDBPreHeader pre_header;
@@ -823,6 +1009,50 @@ u32 RemoveTicketFromDB(const char* path, const u8* title_id) {
     return 0;
 }
 
+u32 RemoveTitleInfoEntriesFromDB(const char* path, const u8* title_ids, u32 n_title_ids, bool* removed) {
+    FIL file;
+    TitleDBPreHeader pre_header;
+
+    if (fvx_open(&file, path, FA_READ | FA_WRITE | FA_OPEN_EXISTING) != FR_OK)
+        return 1;
+
+    bdrifp = &file;
+
+    if ((BDRIRead(0, sizeof(TitleDBPreHeader), &pre_header) != FR_OK) ||
+        !CheckDBMagic((u8*) &pre_header, false) ||
+        (RemoveBDRIEntries(&(pre_header.fs_header), sizeof(TitleDBPreHeader) - sizeof(BDRIFsHeader), title_ids, n_title_ids, removed) != 0)) {
+        fvx_close(bdrifp);
+        bdrifp = NULL;
+        return 1;
+    }
+
+    fvx_close(bdrifp);
+    bdrifp = NULL;
+    return 0;
+}
+
+u32 RemoveTicketsFromDB(const char* path, const u8* title_ids, u32 n_title_ids, bool* removed) {
+    FIL file;
+    TickDBPreHeader pre_header;
+
+    if (fvx_open(&file, path, FA_READ | FA_WRITE | FA_OPEN_EXISTING) != FR_OK)
+        return 1;
+
+    bdrifp = &file;
+
+    if ((BDRIRead(0, sizeof(TickDBPreHeader), &pre_header) != FR_OK) ||
+        !CheckDBMagic((u8*) &pre_header, true) ||
+        (RemoveBDRIEntries(&(pre_header.fs_header), sizeof(TickDBPreHeader) - sizeof(BDRIFsHeader), title_ids, n_title_ids, removed) != 0)) {
+        fvx_close(bdrifp);
+        bdrifp = NULL;
+        return 1;
+    }
+
+    fvx_close(&file);
+    bdrifp = NULL;
+    return 0;
+}
+
 u32 AddTitleInfoEntryToDB(const char* path, const u8* title_id, const TitleInfoEntry* tie, bool replace) {
     FIL file;
     TitleDBPreHeader pre_header;
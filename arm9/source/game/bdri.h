@@ -12,7 +12,10 @@ u32 ListTitleInfoEntryTitleIDs(const char* path, u8* title_ids, u32 max_title_id
 u32 ListTicketTitleIDs(const char* path, u8* title_ids, u32 max_title_ids);
 u32 ReadTitleInfoEntryFromDB(const char* path, const u8* title_id, TitleInfoEntry* tie);
 u32 ReadTicketFromDB(const char* path, const u8* title_id, Ticket** ticket);
+u32 ReadAllTicketsFromDB(const char* path, u32 (*callback)(Ticket* ticket, void* userdata), void* userdata);
 u32 RemoveTitleInfoEntryFromDB(const char* path, const u8* title_id);
 u32 RemoveTicketFromDB(const char* path, const u8* title_id);
+u32 RemoveTitleInfoEntriesFromDB(const char* path, const u8* title_ids, u32 n_title_ids, bool* removed);
+u32 RemoveTicketsFromDB(const char* path, const u8* title_ids, u32 n_title_ids, bool* removed);
 u32 AddTitleInfoEntryToDB(const char* path, const u8* title_id, const TitleInfoEntry* tie, bool replace);
 u32 AddTicketToDB(const char* path, const u8* title_id, const Ticket* ticket, bool replace);
@@ -72,7 +72,8 @@ u32 SetNcchKey(NcchHeader* ncch, u16 crypto, u32 keyid) {
     if ((keyslot != 0x2C) && (LoadKeyFromFile(NULL, keyslot, 'X', NULL) != 0))
         return 1;
 
-    // key Y for seed and non seed
+    // key Y for seed and non seed (only reprogrammed if changed)
+    AesContext ctx;
     if (keyid && (flags7 & 0x20)) { // seed crypto
         static u8 seedkeyY[16+16] __attribute__((aligned(32))) = { 0 };
         static u8 lsignature[16] = { 0 };
@@ -86,11 +87,11 @@ u32 SetNcchKey(NcchHeader* ncch, u16 crypto, u32 keyid) {
             memcpy(lsignature, ncch->signature, 16);
             ltitleId = ncch->programId;
         }
-        setup_aeskeyY(keyslot, seedkeyY);
+        aes_init_context(&ctx, keyslot, seedkeyY);
     } else { // no seed crypto
-        setup_aeskeyY(keyslot, ncch->signature);
+        aes_init_context(&ctx, keyslot, ncch->signature);
     }
-    use_aeskey(keyslot);
+    aes_use_context(&ctx);
 
     return 0;
 }
@@ -106,8 +107,8 @@ u32 SetupNcchCrypto(NcchHeader* ncch, u16 crypt_to) {
     return res_from | res_to;
 }
 
-u32 CryptNcchSection(void* data, u32 offset_data, u32 size_data, u32 offset_section, u32 size_section,
-    u32 offset_ctr, NcchHeader* ncch, u32 snum, u16 crypt_to, u32 keyid) {
+static u32 CryptNcchSectionCtr(void* data, u32 offset_data, u32 size_data, u32 offset_section, u32 size_section,
+    u32 offset_ctr, NcchHeader* ncch, u8* ctr, u16 crypt_to, u32 keyid) {
     u16 crypt_from = NCCH_GET_CRYPTO(ncch);
     const u32 mode = AES_CNT_CTRNAND_MODE;
 
@@ -131,8 +132,6 @@ u32 CryptNcchSection(void* data, u32 offset_data, u32 size_data, u32 offset_sect
         size_i = size_data - (data_i - data8);
 
     // actual decryption stuff
-    u8 ctr[16];
-    GetNcchCtr(ctr, ncch, snum);
     if (!(crypt_from & NCCH_NOCRYPTO)) {
         if (SetNcchKey(ncch, crypt_from, keyid) != 0) return 1;
         ctr_decrypt_byte(data_i, data_i, size_i, offset_i + offset_ctr, mode, ctr);
@@ -145,8 +144,64 @@ u32 CryptNcchSection(void* data, u32 offset_data, u32 size_data, u32 offset_sect
     return 0;
 }
 
-// on the fly de-/encryptor for NCCH
-u32 CryptNcch(void* data, u32 offset, u32 size, NcchHeader* ncch, ExeFsHeader* exefs, u16 crypt_to) {
+u32 CryptNcchSection(void* data, u32 offset_data, u32 size_data, u32 offset_section, u32 size_section,
+    u32 offset_ctr, NcchHeader* ncch, u32 snum, u16 crypt_to, u32 keyid) {
+    u8 ctr[16];
+    GetNcchCtr(ctr, ncch, snum);
+    return CryptNcchSectionCtr(data, offset_data, size_data, offset_section, size_section,
+        offset_ctr, ncch, ctr, crypt_to, keyid);
+}
+
+static void AddNcchCryptRegion(NcchCryptMap* map, u32 offset, u32 size, u32 offset_ctr, u8 snum, u8 keyid) {
+    if (!size || (map->n_regions >= NCCH_CRYPTMAP_MAX)) return;
+    // insertion sort, there are only a few regions
+    u32 i = map->n_regions++;
+    for (; i && (map->regions[i-1].offset > offset); i--)
+        map->regions[i] = map->regions[i-1];
+    NcchCryptRegion* region = map->regions + i;
+    region->offset = offset;
+    region->size = size;
+    region->offset_ctr = offset_ctr;
+    region->snum = snum;
+    region->keyid = keyid;
+}
+
+u32 BuildNcchCryptMap(NcchCryptMap* map, NcchHeader* ncch, ExeFsHeader* exefs) {
+    memset(map, 0, sizeof(NcchCryptMap));
+    for (u32 s = 0; s < 3; s++)
+        GetNcchCtr(map->ctr[s], ncch, s + 1);
+
+    // exthdr
+    if (ncch->size_exthdr)
+        AddNcchCryptRegion(map, NCCH_EXTHDR_OFFSET, NCCH_EXTHDR_SIZE, 0, 1, 0);
+
+    // exefs header and files (+ padding, always standard key)
+    if (ncch->size_exefs) {
+        u32 offset_exefs = ncch->offset_exefs * NCCH_MEDIA_UNIT;
+        AddNcchCryptRegion(map, offset_exefs, 0x200, 0, 2, 0);
+        if (exefs) for (u32 i = 0; i < 10; i++) {
+            ExeFsFileHeader* file = exefs->files + i;
+            if (!file->size) continue;
+            u32 offset_file = offset_exefs + 0x200 + file->offset;
+            u32 size_pad = align(file->size, NCCH_MEDIA_UNIT) - file->size;
+            AddNcchCryptRegion(map, offset_file, file->size, 0x200 + file->offset, 2, EXEFS_KEYID(file->name));
+            AddNcchCryptRegion(map, offset_file + file->size, size_pad, 0x200 + file->offset + file->size, 2, 0);
+        }
+    }
+
+    // romfs
+    if (ncch->size_romfs)
+        AddNcchCryptRegion(map, ncch->offset_romfs * NCCH_MEDIA_UNIT, ncch->size_romfs * NCCH_MEDIA_UNIT, 0, 3, 1);
+
+    for (u32 i = 1; i < map->n_regions; i++)
+        if (map->regions[i].offset < map->regions[i-1].offset + map->regions[i-1].size)
+            map->overlapping = true;
+
+    return 0;
+}
+
+// on the fly de-/encryptor for NCCH, using a prebuilt crypto region map
+u32 CryptNcchMapped(void* data, u32 offset, u32 size, NcchHeader* ncch, NcchCryptMap* map, u16 crypt_to) {
     const u32 offset_flag3 = 0x188 + 3;
     const u32 offset_flag7 = 0x188 + 7;
     u16 crypt_from = NCCH_GET_CRYPTO(ncch);
@@ -163,55 +218,40 @@ u32 CryptNcch(void* data, u32 offset, u32 size, NcchHeader* ncch, ExeFsHeader* e
         ((u8*)data)[offset_flag7 - offset] |= (crypt_to & (0x01|0x20|0x04));
     }
 
-    // exthdr handling
-    if (ncch->size_exthdr) {
-        if (CryptNcchSection(data, offset, size,
-            NCCH_EXTHDR_OFFSET,
-            NCCH_EXTHDR_SIZE,
-            0, ncch, 1, crypt_to, 0) != 0) return 1;
+    // binary search for the first region ending after offset
+    // (regions don't overlap, so their end offsets are sorted, too)
+    u32 lo = 0;
+    u32 hi = map->overlapping ? 0 : map->n_regions;
+    while (lo < hi) {
+        u32 mid = (lo + hi) / 2;
+        NcchCryptRegion* region = map->regions + mid;
+        if (region->offset + region->size <= offset) lo = mid + 1;
+        else hi = mid;
     }
 
-    // exefs handling
-    if (ncch->size_exefs) {
-        // exefs header handling
-        if (CryptNcchSection(data, offset, size,
-            ncch->offset_exefs * NCCH_MEDIA_UNIT,
-            0x200, 0, ncch, 2, crypt_to, 0) != 0) return 1;
-
-        // exefs file handling
-        if (exefs) for (u32 i = 0; i < 10; i++) {
-            ExeFsFileHeader* file = exefs->files + i;
-            if (!file->size) continue;
-
-            u32 offset_file = (ncch->offset_exefs * NCCH_MEDIA_UNIT) + 0x200 + file->offset;
-            u32 size_file = file->size;
-            u32 offset_pad = offset_file + size_file;
-            u32 size_pad = align(size_file, NCCH_MEDIA_UNIT) - size_file;
-
-            if (CryptNcchSection(data, offset, size, offset_file, size_file, 0x200 + file->offset,
-                ncch, 2, crypt_to, EXEFS_KEYID(file->name)) != 0) return 1;
-            if (CryptNcchSection(data, offset, size, offset_pad, size_pad, 0x200 + file->offset + file->size,
-                ncch, 2, crypt_to, 0) != 0) return 1;
-        }
-    }
-
-    // romfs handling
-    if (ncch->size_romfs) {
-        if (CryptNcchSection(data, offset, size,
-            ncch->offset_romfs * NCCH_MEDIA_UNIT,
-            ncch->size_romfs * NCCH_MEDIA_UNIT,
-            0, ncch, 3, crypt_to, 1) != 0) return 1;
+    for (u32 i = lo; (i < map->n_regions) && (map->regions[i].offset < offset + size); i++) {
+        NcchCryptRegion* region = map->regions + i;
+        if (CryptNcchSectionCtr(data, offset, size, region->offset, region->size, region->offset_ctr,
+            ncch, map->ctr[region->snum - 1], crypt_to, region->keyid) != 0) return 1;
     }
 
     return 0;
 }
 
+// on the fly de-/encryptor for NCCH
+u32 CryptNcch(void* data, u32 offset, u32 size, NcchHeader* ncch, ExeFsHeader* exefs, u16 crypt_to) {
+    NcchCryptMap map;
+    if (BuildNcchCryptMap(&map, ncch, exefs) != 0) return 1;
+    return CryptNcchMapped(data, offset, size, ncch, &map, crypt_to);
+}
+
 // on the fly de- / encryptor for NCCH - sequential
 u32 CryptNcchSequential(void* data, u32 offset, u32 size, u16 crypt_to) {
     // warning: this will only work for sequential processing
     // unexpected results otherwise
     static NcchHeader ncch = { 0 };
     static ExeFsHeader exefs = { 0 };
+    static NcchCryptMap map = { 0 }; // rebuilt whenever a header is fetched
     static NcchHeader* ncchptr = NULL;
     static ExeFsHeader* exefsptr = NULL;
 
@@ -220,6 +260,7 @@ u32 CryptNcchSequential(void* data, u32 offset, u32 size, u16 crypt_to) {
         memcpy(&ncch, data, sizeof(NcchHeader));
         ncchptr = (ValidateNcchHeader(&ncch) == 0) ? &ncch : NULL;
         exefsptr = NULL;
+        if (ncchptr) BuildNcchCryptMap(&map, ncchptr, NULL);
     }
 
     // safety check, ncch pointer
@@ -236,10 +277,11 @@ u32 CryptNcchSequential(void* data, u32 offset, u32 size, u16 crypt_to) {
                 return 1;
             if (ValidateExeFsHeader(&exefs, 0) != 0) return 1;
             exefsptr = &exefs;
+            BuildNcchCryptMap(&map, ncchptr, exefsptr);
         }
     }
 
-    return CryptNcch(data, offset, size, ncchptr, exefsptr, crypt_to);
+    return CryptNcchMapped(data, offset, size, ncchptr, &map, crypt_to);
 }
 
 u32 SetNcchSdFlag(void* data) { // data must be at least 0x600 byte and start with NCCH header
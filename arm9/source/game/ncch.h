@@ -8,6 +8,7 @@
 
 #define NCCH_EXTHDR_SIZE 0x800 // NCCH header says 0x400, which is not the full thing
 #define NCCH_EXTHDR_OFFSET 0x200
+#define NCCH_CRYPTMAP_MAX (2 + (2*10) + 1) // exthdr, exefs header, exefs files + padding, romfs
 
 #define NCCH_ENCRYPTED(ncch) (!((ncch)->flags[7] & 0x04))
 #define NCCH_IS_CXI(ncch) ((ncch)->flags[5] & 0x02)
@@ -83,9 +84,28 @@ typedef struct {
     u8  hash_romfs[0x20];
 } __attribute__((packed, aligned(16))) NcchHeader;
 
+// crypto region: one range of the NCCH with the same key and counter base
+typedef struct {
+    u32 offset; // offset inside the NCCH
+    u32 size;
+    u32 offset_ctr; // offset of the region inside its section
+    u8  snum; // 1: exthdr / 2: exefs / 3: romfs
+    u8  keyid;
+} NcchCryptRegion;
+
+// crypto region map, sorted by offset, built once per NCCH
+typedef struct {
+    u32 n_regions;
+    bool overlapping; // regions overlap (broken NCCH), no binary search
+    u8  ctr[3][16]; // counter base for each section
+    NcchCryptRegion regions[NCCH_CRYPTMAP_MAX];
+} NcchCryptMap;
+
 u32 ValidateNcchHeader(NcchHeader* header);
 u32 SetNcchKey(NcchHeader* ncch, u16 crypto, u32 keyid);
 u32 SetupNcchCrypto(NcchHeader* ncch, u16 crypt_to);
+u32 BuildNcchCryptMap(NcchCryptMap* map, NcchHeader* ncch, ExeFsHeader* exefs);
+u32 CryptNcchMapped(void* data, u32 offset, u32 size, NcchHeader* ncch, NcchCryptMap* map, u16 crypto);
 u32 CryptNcch(void* data, u32 offset, u32 size, NcchHeader* ncch, ExeFsHeader* exefs, u16 crypto);
 u32 CryptNcchSequential(void* data, u32 offset, u32 size, u16 crypto);
 u32 SetNcchSdFlag(void* data);
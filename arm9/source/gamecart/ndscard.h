@@ -9,6 +9,7 @@
 #pragma once
 #include <arm.h>
 #include <inttypes.h>
+#include "ndma.h"
 
 #define u8 uint8_t
 #define u16 uint16_t
@@ -87,10 +88,6 @@
 
 #define swiDelay(n) ARM_WaitCycles((n) * 8)
 
-#define DMA_SRC(n)      (*(vu32*)(0x10002004 + (n * 0x1c)))
-#define DMA_DEST(n)     (*(vu32*)(0x10002008 + (n * 0x1c)))
-#define DMA_CR(n)       (*(vu32*)(0x1000201C + (n * 0x1c)))
-
 #define DMA_ENABLE      (1u << 31)
 #define DMA_START_CARD  (5u << 27)
 #define DMA_32_BIT      (1u << 26)
@@ -12,24 +12,12 @@
 #include <stdio.h>
 
 #include "common.h"
+#include "aes.h"
 #include "protocol_ctr.h"
 #include "protocol_ntr.h"
 #include "command_ctr.h"
 #include "command_ntr.h"
 
-// could have been done better, but meh...
-#define REG_AESCNT      (*(vu32*)0x10009000)
-#define REG_AESBLKCNT   (*(vu32*)0x10009004)
-#define REG_AESWRFIFO   (*(vu32*)0x10009008)
-#define REG_AESRDFIFO   (*(vu32*)0x1000900C)
-#define REG_AESKEYSEL   (*(vu8*)0x10009010)
-#define REG_AESKEYCNT   (*(vu8*)0x10009011)
-#define REG_AESCTR      ((vu32*)0x10009020) // 16
-#define REG_AESMAC      ((vu32*)0x10009030) // 16
-#define REG_AESKEYFIFO  (*(vu32*)0x10009100)
-#define REG_AESKEYXFIFO (*(vu32*)0x10009104)
-#define REG_AESKEYYFIFO (*(vu32*)0x10009108)
-
 u32 CartID = 0xFFFFFFFFu;
 u32 CartType = 0;
 
@@ -106,17 +94,17 @@ void Cart_Init(void)
 }
 
 static void AES_SetKeyControl(u32 a) {
-    REG_AESKEYCNT = (REG_AESKEYCNT & 0xC0) | a | 0x80;
+    *REG_AESKEYCNT = (*REG_AESKEYCNT & 0xC0) | a | 0x80;
 }
 
 //returns 1 if MAC valid otherwise 0
 static u8 card_aes(u32 *out, u32 *buff, size_t size) { // note size param ignored
     (void) size;
-    REG_AESCNT = 0x10C00;    //flush r/w fifo macsize = 001
+    *REG_AESCNT = 0x10C00;    //flush r/w fifo macsize = 001
 
     (*(vu8*)0x10000008) |= 0x0C; //???
 
-    REG_AESCNT |= 0x2800000;
+    *REG_AESCNT |= 0x2800000;
 
     //const u8 is_dev_unit = *(vu8*)0x10010010;
     //if(is_dev_unit) //Dev unit
@@ -124,50 +112,52 @@ static u8 card_aes(u32 *out, u32 *buff, size_t size) { // note size param ignore
     if(is_dev_cart) //Dev unit
     {
         AES_SetKeyControl(0x11);
-        REG_AESKEYFIFO = 0;
-        REG_AESKEYFIFO = 0;
-        REG_AESKEYFIFO = 0;
-        REG_AESKEYFIFO = 0;
-        REG_AESKEYSEL = 0x11;
+        *REG_AESKEYFIFO = 0;
+        *REG_AESKEYFIFO = 0;
+        *REG_AESKEYFIFO = 0;
+        *REG_AESKEYFIFO = 0;
+        *REG_AESKEYSEL = 0x11;
     }
     else
     {
         AES_SetKeyControl(0x3B);
-        REG_AESKEYYFIFO = buff[0];
-        REG_AESKEYYFIFO = buff[1];
-        REG_AESKEYYFIFO = buff[2];
-        REG_AESKEYYFIFO = buff[3];
-        REG_AESKEYSEL = 0x3B;
+        *REG_AESKEYYFIFO = buff[0];
+        *REG_AESKEYYFIFO = buff[1];
+        *REG_AESKEYYFIFO = buff[2];
+        *REG_AESKEYYFIFO = buff[3];
+        *REG_AESKEYSEL = 0x3B;
     }
+    // keys were written directly, aes_use_context() must not rely on its key Y here
+    aes_invalidate_keyy(is_dev_cart ? 0x11 : 0x3B);
 
-    REG_AESCNT = 0x4000000;
-    REG_AESCNT &= 0xFFF7FFFF;
-    REG_AESCNT |= 0x2970000;
+    *REG_AESCNT = 0x4000000;
+    *REG_AESCNT &= 0xFFF7FFFF;
+    *REG_AESCNT |= 0x2970000;
     REG_AESMAC[0] = buff[11];
     REG_AESMAC[1] = buff[10];
     REG_AESMAC[2] = buff[9];
     REG_AESMAC[3] = buff[8];
-    REG_AESCNT |= 0x2800000;
+    *REG_AESCNT |= 0x2800000;
     REG_AESCTR[0] = buff[14];
     REG_AESCTR[1] = buff[13];
     REG_AESCTR[2] = buff[12];
-    REG_AESBLKCNT = 0x10000;
+    *REG_AESBLKCNT = 0x10000;
 
-    u32 v11 = ((REG_AESCNT | 0x80000000) & 0xC7FFFFFF); //Start and clear mode (ccm decrypt)
+    u32 v11 = ((*REG_AESCNT | 0x80000000) & 0xC7FFFFFF); //Start and clear mode (ccm decrypt)
     u32 v12 = v11 & 0xBFFFFFFF; //Disable Interrupt
-    REG_AESCNT = ((((v12 | 0x3000) & 0xFD7F3FFF) | (5 << 23)) & 0xFEBFFFFF) | (5 << 22);
-
-    //REG_AESCNT = 0x83D73C00;
-    REG_AESWRFIFO = buff[4];
-    REG_AESWRFIFO = buff[5];
-    REG_AESWRFIFO = buff[6];
-    REG_AESWRFIFO = buff[7];
-    while (((REG_AESCNT >> 5) & 0x1F) <= 3);
-    out[0] = REG_AESRDFIFO;
-    out[1] = REG_AESRDFIFO;
-    out[2] = REG_AESRDFIFO;
-    out[3] = REG_AESRDFIFO;
-    return ((REG_AESCNT >> 21) & 1);
+    *REG_AESCNT = ((((v12 | 0x3000) & 0xFD7F3FFF) | (5 << 23)) & 0xFEBFFFFF) | (5 << 22);
+
+    //*REG_AESCNT = 0x83D73C00;
+    *REG_AESWRFIFO = buff[4];
+    *REG_AESWRFIFO = buff[5];
+    *REG_AESWRFIFO = buff[6];
+    *REG_AESWRFIFO = buff[7];
+    while (((*REG_AESCNT >> 5) & 0x1F) <= 3);
+    out[0] = *REG_AESRDFIFO;
+    out[1] = *REG_AESRDFIFO;
+    out[2] = *REG_AESRDFIFO;
+    out[3] = *REG_AESRDFIFO;
+    return ((*REG_AESCNT >> 21) & 1);
 }
 
 void Cart_Secure_Init(u32 *buf, u32 *out)
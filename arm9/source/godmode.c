@@ -1163,6 +1163,7 @@ u32 FileHandlerMenu(char* current_path, u32* cursor, u32* scroll, PaneData** pan
         !(drvtype & DRV_TWLNAND) && !(drvtype & DRV_ALIAS) && !(drvtype & DRV_IMAGE);
     bool tik_installable = (FTYPE_TIKINSTALL(filetype)) && !(drvtype & DRV_IMAGE);
     bool tik_dumpable = (FTYPE_TIKDUMP(filetype));
+    bool tik_bulkdumpable = (FTYPE_TIKBULKDUMP(filetype)) && !in_output_path;
     bool cif_installable = (FTYPE_CIFINSTALL(filetype)) && !(drvtype & DRV_IMAGE);
     bool uninstallable = (FTYPE_UNINSTALL(filetype));
     bool cxi_dumpable = (FTYPE_CXIDUMP(filetype));
@@ -1207,7 +1208,8 @@ u32 FileHandlerMenu(char* current_path, u32* cursor, u32* scroll, PaneData** pan
         cxi_dumpable || tik_buildable || key_buildable || titleinfo || renamable || trimable || transferable ||
         hsinjectable || restorable || xorpadable || ebackupable || ncsdfixable || extrcodeable || keyinitable ||
         keyinstallable || bootable || scriptable || fontable || translationable || viewable || installable ||
-        agbexportable || agbimportable || cia_installable || tik_installable || tik_dumpable || cif_installable;
+        agbexportable || agbimportable || cia_installable || tik_installable || tik_dumpable || tik_bulkdumpable ||
+        cif_installable;
 
     char pathstr[UTF_BUFFER_BYTESIZE(32)];
     TruncateString(pathstr, file_path, 32, 8);
@@ -1435,6 +1437,7 @@ u32 FileHandlerMenu(char* current_path, u32* cursor, u32* scroll, PaneData** pan
     int cia_install = (cia_installable) ? ++n_opt : -1;
     int tik_install = (tik_installable) ? ++n_opt : -1;
     int tik_dump = (tik_dumpable) ? ++n_opt : -1;
+    int tik_bulkdump = (tik_bulkdumpable) ? ++n_opt : -1;
     int cif_install = (cif_installable) ? ++n_opt : -1;
     int uninstall = (uninstallable) ? ++n_opt : -1;
     int tik_build_enc = (tik_buildable) ? ++n_opt : -1;
@@ -1472,6 +1475,7 @@ u32 FileHandlerMenu(char* current_path, u32* cursor, u32* scroll, PaneData** pan
     if (cia_install > 0) optionstr[cia_install-1] = STR_INSTALL_GAME_IMAGE;
     if (tik_install > 0) optionstr[tik_install-1] = STR_INSTALL_TICKET;
     if (tik_dump > 0) optionstr[tik_dump-1] = STR_DUMP_TICKET_FILE;
+    if (tik_bulkdump > 0) optionstr[tik_bulkdump-1] = STR_DUMP_ALL_TICKETS;
     if (cif_install > 0) optionstr[cif_install-1] = STR_INSTALL_CIFINISH_BIN;
     if (uninstall > 0) optionstr[uninstall-1] = STR_UNINSTALL_TITLE;
     if (tik_build_enc > 0) optionstr[tik_build_enc-1] = buildtikdbenc_str;
@@ -1547,33 +1551,11 @@ u32 FileHandlerMenu(char* current_path, u32* cursor, u32* scroll, PaneData** pan
         bool inplace = (user_select == 2);
         if (!user_select) { // do nothing when no choice is made
         } else if ((n_marked > 1) && ShowPrompt(true, STR_TRY_TO_DECRYPT_ALL_N_SELECTED_FILES, n_marked)) {
-            u32 n_success = 0;
             u32 n_unencrypted = 0;
             u32 n_other = 0;
             ShowString(STR_TRYING_TO_DECRYPT_N_FILES, n_marked);
-            for (u32 i = 0; i < current_dir->n_entries; i++) {
-                const char* path = current_dir->entry[i].path;
-                if (!current_dir->entry[i].marked)
-                    continue;
-                if (!(IdentifyFileType(path) & filetype & TYPE_BASE)) {
-                    n_other++;
-                    continue;
-                }
-                if (!(filetype & BIN_KEYDB) && (CheckEncryptedGameFile(path) != 0)) {
-                    n_unencrypted++;
-                    continue;
-                }
-                DrawDirContents(current_dir, (*cursor = i), scroll);
-                if (!(filetype & BIN_KEYDB) && (CryptGameFile(path, inplace, false) == 0)) n_success++;
-                else if ((filetype & BIN_KEYDB) && (CryptAesKeyDb(path, inplace, false) == 0)) n_success++;
-                else { // on failure: show error, continue
-                    char lpathstr[UTF_BUFFER_BYTESIZE(32)];
-                    TruncateString(lpathstr, path, 32, 8);
-                    if (ShowPrompt(true, "%s\n%s", lpathstr, STR_DECRYPTION_FAILED_CONTINUE)) continue;
-                    else break;
-                }
-                current_dir->entry[i].marked = false;
-            }
+            u32 n_success = CryptGameFileBatch(current_dir, filetype, inplace, false, &n_unencrypted, &n_other,
+                DrawDirContents, cursor, scroll);
             if (n_other || n_unencrypted) {
                 ShowPrompt(false, STR_N_OF_N_FILES_DECRYPTED_N_OF_N_NOT_ENCRYPTED_N_OF_N_NOT_SAME_TYPE,
                     n_success, n_marked, n_unencrypted, n_marked, n_other, n_marked);
@@ -1604,28 +1586,12 @@ u32 FileHandlerMenu(char* current_path, u32* cursor, u32* scroll, PaneData** pan
         bool inplace = (user_select == 2);
         if (!user_select) { // do nothing when no choice is made
         } else if ((n_marked > 1) && ShowPrompt(true, STR_TRY_TO_ENCRYPT_N_SELECTED_FILES, n_marked)) {
-            u32 n_success = 0;
+            u32 n_encrypted = 0;
             u32 n_other = 0;
             ShowString(STR_TRYING_TO_ENCRYPT_N_FILES, n_marked);
-            for (u32 i = 0; i < current_dir->n_entries; i++) {
-                const char* path = current_dir->entry[i].path;
-                if (!current_dir->entry[i].marked)
-                    continue;
-                if (!(IdentifyFileType(path) & filetype & TYPE_BASE)) {
-                    n_other++;
-                    continue;
-                }
-                DrawDirContents(current_dir, (*cursor = i), scroll);
-                if (!(filetype & BIN_KEYDB) && (CryptGameFile(path, inplace, true) == 0)) n_success++;
-                else if ((filetype & BIN_KEYDB) && (CryptAesKeyDb(path, inplace, true) == 0)) n_success++;
-                else { // on failure: show error, continue
-                    char lpathstr[UTF_BUFFER_BYTESIZE(32)];
-                    TruncateString(lpathstr, path, 32, 8);
-                    if (ShowPrompt(true, "%s\n%s", lpathstr, STR_ENCRYPTION_FAILED_CONTINUE)) continue;
-                    else break;
-                }
-                current_dir->entry[i].marked = false;
-            }
+            u32 n_success = CryptGameFileBatch(current_dir, filetype, inplace, true, &n_encrypted, &n_other,
+                DrawDirContents, cursor, scroll);
+            n_success += n_encrypted; // already encrypted files count as done
             if (n_other) {
                 ShowPrompt(false, STR_N_OF_N_FILES_ENCRYPTED_N_OF_N_NOT_SAME_TYPE,
                     n_success, n_marked, n_other, n_marked);
@@ -1757,16 +1723,8 @@ u32 FileHandlerMenu(char* current_path, u32* cursor, u32* scroll, PaneData** pan
         // batch uninstall
         if (n_marked > 1) {
             u32 n_success = 0;
-            u32 num = 0;
-            for (u32 i = 0; i < current_dir->n_entries; i++) {
-                const char* path = current_dir->entry[i].path;
-                if (!current_dir->entry[i].marked) continue;
-                if (!(IdentifyFileType(path) & filetype & TYPE_BASE)) continue;
-                if (!num && !CheckWritePermissions(path)) break;
-                if (!ShowProgress(num++, n_marked, path)) break;
-                if (UninstallGameDataTie(path, true, full_uninstall, full_uninstall) == 0)
-                    n_success++;
-            }
+            if (CheckWritePermissions(file_path))
+                n_success = UninstallGameDataTieBatch(current_dir, filetype, true, full_uninstall, full_uninstall);
             ShowPrompt(false, STR_N_OF_N_TITLES_UNINSTALLED, n_success, n_marked);
         } else if (CheckWritePermissions(file_path)) {
             ShowString("%s\n%s", pathstr, STR_UNINSTALLING_PLEASE_WAIT);
@@ -1851,6 +1809,19 @@ u32 FileHandlerMenu(char* current_path, u32* cursor, u32* scroll, PaneData** pan
         }
         return 0;
     }
+    else if (user_select == tik_bulkdump) { // dump all tickets from ticket.db
+        const char* optionstr_out[2] = { STR_ALL_TICKETS_TO_BUNDLE, STR_ALL_TICKETS_TO_SEPARATE_FILES };
+        u32 n_dumped = 0;
+        u32 n_existing = 0;
+        u32 n_filtered = 0;
+        u32 out_select = ShowSelectPrompt(2, optionstr_out, STR_PATH_DUMP_ALL_TICKETS_CHOOSE_OUTPUT, pathstr, OUTPUT_PATH);
+        if (!out_select) return 0;
+        bool force_legit = ShowPrompt(true, "%s\n%s", pathstr, STR_DUMP_LEGIT_TICKETS_ONLY);
+        if (DumpTicketsFromDB(file_path, force_legit, (out_select == 1), &n_dumped, &n_existing, &n_filtered) == 0)
+            ShowPrompt(false, STR_N_TICKETS_DUMPED_N_EXISTING_N_FILTERED_TO_OUT, n_dumped, n_existing, n_filtered, OUTPUT_PATH);
+        else ShowPrompt(false, "%s\n%s", pathstr, STR_DUMP_TICKETS_FAILED);
+        return 0;
+    }
     else if ((user_select == tik_build_enc) || (user_select == tik_build_dec)) { // -> (re)build titlekey database
         bool dec = (user_select == tik_build_dec);
         const char* path_out = (dec) ? OUTPUT_PATH "/" TIKDB_NAME_DEC : OUTPUT_PATH "/" TIKDB_NAME_ENC;
@@ -807,3 +807,11 @@ STRING(SYSINFO_SD_CID, "SD CID: %s\r\n")
 STRING(SYSINFO_SYSTEM_ID0, "System ID0: %s\r\n")
 STRING(SYSINFO_SYSTEM_ID1, "System ID1: %s\r\n")
 STRING(SORTING_TICKETS_PLEASE_WAIT, "Sorting tickets, please wait ...")
+STRING(DUMP_ALL_TICKETS, "Dump all tickets")
+STRING(ALL_TICKETS_TO_BUNDLE, "To single bundle file")
+STRING(ALL_TICKETS_TO_SEPARATE_FILES, "To separate ticket files")
+STRING(PATH_DUMP_ALL_TICKETS_CHOOSE_OUTPUT, "%s\nDump all tickets to %s.\nChoose output format:")
+STRING(DUMP_LEGIT_TICKETS_ONLY, "Dump only tickets with a valid signature?")
+STRING(N_TICKETS_DUMPED_N_EXISTING_N_FILTERED_TO_OUT, "%lu new tickets dumped\n%lu already present\n%lu skipped\n \nOutput: %s")
+STRING(DUMP_TICKETS_FAILED, "Dump tickets failed!")
+STRING(WRITING_BOSS_REPORT_FAILED, "Writing BOSS report failed!")
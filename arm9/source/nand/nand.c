@@ -12,6 +12,11 @@
 #define KEY95_SHA256    ((IS_DEVKIT) ? slot0x11Key95dev_sha256 : slot0x11Key95_sha256)
 #define SECTOR_SHA256   ((IS_DEVKIT) ? sector0x96dev_sha256 : sector0x96_sha256)
 
+#define NAND_PIPE_SECTORS   0x80 // chunk size for pipelined (NDMA) reads
+#define NAND_WRITE_CHUNK    0x40000 // size of each of the two write bounce buffers
+#define NAND_BYTES_CACHE    4 // # of sectors cached for ReadNandBytes() / WriteNandBytes()
+#define EMUNAND_INDEX_MAX   32 // max # of EmuNANDs kept in the index
+
 // see: https://www.3dbrew.org/wiki/NCSD#NCSD_header
 static const u32 np_keyslots[10][4] = { // [NP_TYPE][NP_SUBTYPE]
     { 0xFF, 0xFF, 0xFF, 0xFF }, // none
@@ -61,6 +66,29 @@ static bool Crypto0x96 = false;
 
 static u32 emunand_base_sector = 0x000000;
 
+static u8* nand_wbuf[2] = { NULL }; // cache line aligned, see InitNandWriteBuffers()
+static bool nand_wbuf_busy = false; // set while a WriteNandSectors() call owns nand_wbuf
+
+typedef struct {
+    u32 nand; // 0 -> invalid
+    u32 sector;
+    u32 keyslot;
+    u8  data[0x200]; // decrypted
+} NandSectorCache;
+
+static NandSectorCache nand_bcache[NAND_BYTES_CACHE]; // head / tail sectors of misaligned byte access
+static u32 nand_bcache_next = 0;
+
+typedef struct {
+    bool valid;
+    u32 cid[4]; // SD card CID
+    u32 fat_offset; // start of the SD FAT partition (= end of the hidden area)
+    u32 count;
+    u32 base[EMUNAND_INDEX_MAX];
+} EmuNandIndex;
+
+static EmuNandIndex emunand_index = { .valid = false };
+
 
 bool GetOtp0x90(void* otp0x90, u32 len)
 {
@@ -82,8 +110,18 @@ bool GetOtp0x90(void* otp0x90, u32 len)
     return false;
 }
 
+static void InvalidateNandBytesCache(u32 sector, u32 count, u32 nand)
+{
+    for (u32 i = 0; i < NAND_BYTES_CACHE; i++) {
+        NandSectorCache* entry = &(nand_bcache[i]);
+        if ((entry->nand & nand) && (entry->sector >= sector) && (entry->sector - sector < count))
+            entry->nand = 0;
+    }
+}
+
 bool InitNandCrypto(bool init_full)
 {
+    InvalidateNandBytesCache(0, UINT32_MAX, NAND_SYSNAND | NAND_EMUNAND); // keys may change
     // part #0: KeyX / KeyY for secret sector 0x96
     if (IS_UNLOCKED) { // if OTP is unlocked
         // see: https://www.3dbrew.org/wiki/OTP_Registers
@@ -245,6 +283,42 @@ void CryptSector0x96(void* buffer, bool encrypt)
     ecb_decrypt((void*) buffer, (void*) buffer, 0x200 / AES_BLOCK_SIZE, mode);
 }
 
+static int ReadNandBytesSector(NandSectorCache** entry, u32 sector, u32 keyslot, u32 nand_src)
+{
+    // decrypted sectors for misaligned byte access are cached, as long as
+    // nothing else can change them (ImgNAND is left to the image layer)
+    bool cacheable = (nand_src == NAND_SYSNAND) || (nand_src == NAND_EMUNAND);
+    if (cacheable) {
+        for (u32 i = 0; i < NAND_BYTES_CACHE; i++) {
+            NandSectorCache* e = &(nand_bcache[i]);
+            if ((e->nand == nand_src) && (e->sector == sector) && (e->keyslot == keyslot)) {
+                *entry = e;
+                return 0;
+            }
+        }
+    }
+
+    NandSectorCache* e = &(nand_bcache[nand_bcache_next]);
+    nand_bcache_next = (nand_bcache_next + 1) % NAND_BYTES_CACHE;
+    e->nand = 0;
+    int errorcode = ReadNandSectors(e->data, sector, 1, keyslot, nand_src);
+    if (errorcode != 0) return errorcode;
+    e->sector = sector;
+    e->keyslot = keyslot;
+    e->nand = cacheable ? nand_src : 0;
+    *entry = e;
+    return 0;
+}
+
+static int WriteNandBytesSector(NandSectorCache* entry, u32 sector, u32 keyslot, u32 nand_dst)
+{
+    // write-through, the entry stays valid if the write succeeded
+    u32 nand = entry->nand;
+    int errorcode = WriteNandSectors(entry->data, sector, 1, keyslot, nand_dst);
+    if (errorcode == 0) entry->nand = nand;
+    return errorcode;
+}
+
 int ReadNandBytes(void* buffer, u64 offset, u64 count, u32 keyslot, u32 nand_src)
 {
     if (!(offset % 0x200) && !(count % 0x200)) { // aligned data -> simple case
@@ -252,13 +326,13 @@ int ReadNandBytes(void* buffer, u64 offset, u64 count, u32 keyslot, u32 nand_src
         return ReadNandSectors(buffer, offset / 0x200, count / 0x200, keyslot, nand_src);
     } else { // misaligned data -> -___-
         u8* buffer8 = (u8*) buffer;
-        u8 l_buffer[0x200];
+        NandSectorCache* entry;
         int errorcode = 0;
         if (offset % 0x200) { // handle misaligned offset
             u32 offset_fix = 0x200 - (offset % 0x200);
-            errorcode = ReadNandSectors(l_buffer, offset / 0x200, 1, keyslot, nand_src);
+            errorcode = ReadNandBytesSector(&entry, offset / 0x200, keyslot, nand_src);
             if (errorcode != 0) return errorcode;
-            memcpy(buffer8, l_buffer + 0x200 - offset_fix, min(offset_fix, count));
+            memcpy(buffer8, entry->data + 0x200 - offset_fix, min(offset_fix, count));
             if (count <= offset_fix) return 0;
             offset += offset_fix;
             buffer8 += offset_fix;
@@ -270,9 +344,9 @@ int ReadNandBytes(void* buffer, u64 offset, u64 count, u32 keyslot, u32 nand_src
         }
         if (count % 0x200) { // handle misaligned count
             u32 count_fix = count % 0x200;
-            errorcode = ReadNandSectors(l_buffer, (offset + count) / 0x200, 1, keyslot, nand_src);
+            errorcode = ReadNandBytesSector(&entry, (offset + count) / 0x200, keyslot, nand_src);
             if (errorcode != 0) return errorcode;
-            memcpy(buffer8 + count - count_fix, l_buffer, count_fix);
+            memcpy(buffer8 + count - count_fix, entry->data, count_fix);
         }
         return errorcode;
     }
@@ -285,14 +359,14 @@ int WriteNandBytes(const void* buffer, u64 offset, u64 count, u32 keyslot, u32 n
         return WriteNandSectors(buffer, offset / 0x200, count / 0x200, keyslot, nand_dst);
     } else { // misaligned data -> -___-
         u8* buffer8 = (u8*) buffer;
-        u8 l_buffer[0x200];
+        NandSectorCache* entry;
         int errorcode = 0;
         if (offset % 0x200) { // handle misaligned offset
             u32 offset_fix = 0x200 - (offset % 0x200);
-            errorcode = ReadNandSectors(l_buffer, offset / 0x200, 1, keyslot, nand_dst);
+            errorcode = ReadNandBytesSector(&entry, offset / 0x200, keyslot, nand_dst);
             if (errorcode != 0) return errorcode;
-            memcpy(l_buffer + 0x200 - offset_fix, buffer8, min(offset_fix, count));
-            errorcode = WriteNandSectors((const u8*) l_buffer, offset / 0x200, 1, keyslot, nand_dst);
+            memcpy(entry->data + 0x200 - offset_fix, buffer8, min(offset_fix, count));
+            errorcode = WriteNandBytesSector(entry, offset / 0x200, keyslot, nand_dst);
             if (errorcode != 0) return errorcode;
             if (count <= offset_fix) return 0;
             offset += offset_fix;
@@ -305,20 +379,44 @@ int WriteNandBytes(const void* buffer, u64 offset, u64 count, u32 keyslot, u32 n
         }
         if (count % 0x200) { // handle misaligned count
             u32 count_fix = count % 0x200;
-            errorcode = ReadNandSectors(l_buffer, (offset + count) / 0x200, 1, keyslot, nand_dst);
+            errorcode = ReadNandBytesSector(&entry, (offset + count) / 0x200, keyslot, nand_dst);
             if (errorcode != 0) return errorcode;
-            memcpy(l_buffer, buffer8 + count - count_fix, count_fix);
-            errorcode = WriteNandSectors((const u8*) l_buffer, (offset + count) / 0x200, 1, keyslot, nand_dst);
+            memcpy(entry->data, buffer8 + count - count_fix, count_fix);
+            errorcode = WriteNandBytesSector(entry, (offset + count) / 0x200, keyslot, nand_dst);
             if (errorcode != 0) return errorcode;
         }
         return errorcode;
     }
 }
 
+static int ReadNandSectorsPipelined(u8* buffer8, u32 sector, u32 count, u32 keyslot, u32 nand_src)
+{
+    // decrypt each chunk while the next one is transferred (needs sdmmc NDMA support)
+    void (*read_async)(u32, u32, u8*) = (nand_src == NAND_EMUNAND) ?
+        sdmmc_sdcard_readsectors_async : sdmmc_nand_readsectors_async;
+    u32 phys = (nand_src == NAND_EMUNAND) ? emunand_base_sector + sector : sector;
+    int errorcode = 0;
+
+    read_async(phys, min(NAND_PIPE_SECTORS, count), buffer8);
+    for (u32 s = 0; s < count; s += NAND_PIPE_SECTORS) {
+        u32 pcount = min(NAND_PIPE_SECTORS, count - s);
+        if ((errorcode = sdmmc_wait()) != 0) break;
+        if (s + pcount < count)
+            read_async(phys + s + pcount, min(NAND_PIPE_SECTORS, count - (s + pcount)), buffer8 + ((s + pcount) * 0x200));
+        CryptNand(buffer8 + (s * 0x200), sector + s, pcount, keyslot);
+    }
+
+    return errorcode;
+}
+
 int ReadNandSectors(void* buffer, u32 sector, u32 count, u32 keyslot, u32 nand_src)
 {
     u8* buffer8 = (u8*) buffer;
     if (!count) return 0; // <--- just to be safe
+    if (((nand_src == NAND_SYSNAND) || ((nand_src == NAND_EMUNAND) && (sector || (emunand_base_sector % 0x200000)))) &&
+        (keyslot < 0x40) && !((keyslot == 0x11) && (sector == SECTOR_SECRET)) &&
+        (count > NAND_PIPE_SECTORS) && sdmmc_can_dma(buffer8, count * 0x200))
+        return ReadNandSectorsPipelined(buffer8, sector, count, keyslot, nand_src);
     if (nand_src == NAND_EMUNAND) { // EmuNAND
         int errorcode = 0;
         if ((sector == 0) && (emunand_base_sector % 0x200000 == 0)) { // GW EmuNAND header handling
@@ -347,34 +445,81 @@ int ReadNandSectors(void* buffer, u32 sector, u32 count, u32 keyslot, u32 nand_s
     return 0;
 }
 
+static u8* AllocNandWriteBuffers(u8** wbuf)
+{
+    u8* buffer = (u8*) malloc((2 * NAND_WRITE_CHUNK) + 0x20);
+    if (!buffer) return NULL;
+    wbuf[0] = (u8*) align((u32) buffer, 0x20);
+    wbuf[1] = wbuf[0] + NAND_WRITE_CHUNK;
+    return buffer;
+}
+
+static bool InitNandWriteBuffers(void)
+{
+    // allocated once, never freed (FatFs writes to NAND come in many small calls)
+    return nand_wbuf[0] || AllocNandWriteBuffers(nand_wbuf);
+}
+
+static int WriteNandChunk(const u8* buffer, u32 sector, u32 count, u32 nand_dst)
+{
+    // SD / eMMC writes are only started here, sdmmc_wait() picks up the result
+    int errorcode = 0;
+    if (nand_dst == NAND_EMUNAND) {
+        if ((sector == 0) && (emunand_base_sector % 0x200000 == 0)) { // GW EmuNAND header handling
+            errorcode = sdmmc_sdcard_writesectors(emunand_base_sector + getMMCDevice(0)->total_size, 1, buffer);
+            if (!errorcode && (count > 1)) sdmmc_sdcard_writesectors_async(emunand_base_sector + 1, count - 1, buffer + 0x200);
+        } else sdmmc_sdcard_writesectors_async(emunand_base_sector + sector, count, buffer);
+    } else if (nand_dst == NAND_IMGNAND) {
+        errorcode = WriteImageSectors(buffer, sector, count);
+    } else if (nand_dst == NAND_SYSNAND) {
+        sdmmc_nand_writesectors_async(sector, count, buffer);
+    } else {
+        errorcode = -1;
+    }
+    return errorcode;
+}
+
 int WriteNandSectors(const void* buffer, u32 sector, u32 count, u32 keyslot, u32 nand_dst)
 {
-    // buffer must not be changed, so this is a little complicated
-    void* nand_buffer = (void*) malloc(min(STD_BUFFER_SIZE, count * 0x200));
-    if (!nand_buffer) return -1;
+    // buffer must not be changed, encryption happens in two alternating bounce buffers
+    // (chunk N+1 is encrypted while chunk N is written), unencrypted data is written directly
+    // nested calls (ImgNAND backed by a file on NAND) get their own bounce buffers
+    const u8* buffer8 = (const u8*) buffer;
+    bool crypto = (keyslot < 0x40);
+    bool nested = nand_wbuf_busy;
+    u8* wbufs[2] = { NULL };
+    u8* wbuf_alloc = NULL;
     int errorcode = 0;
 
-    for (u32 s = 0; s < count; s += (STD_BUFFER_SIZE / 0x200)) {
-        u32 pcount = min((STD_BUFFER_SIZE/0x200), (count - s));
-        memcpy(nand_buffer, ((u8*) buffer) + (s*0x200), pcount * 0x200);
-        if ((keyslot == 0x11) && (sector == SECTOR_SECRET)) CryptSector0x96(nand_buffer, true);
-        else if (keyslot < 0x40) CryptNand(nand_buffer, sector + s, pcount, keyslot);
-        if (nand_dst == NAND_EMUNAND) {
-            if ((sector + s == 0) && (emunand_base_sector % 0x200000 == 0)) { // GW EmuNAND header handling
-                errorcode = sdmmc_sdcard_writesectors(emunand_base_sector + getMMCDevice(0)->total_size, 1, nand_buffer);
-                if (!errorcode && (pcount > 1)) errorcode = sdmmc_sdcard_writesectors(emunand_base_sector + 1, pcount - 1, ((u8*) nand_buffer) + 0x200);
-            } else errorcode = sdmmc_sdcard_writesectors(emunand_base_sector + sector + s, pcount, nand_buffer);
-        } else if (nand_dst == NAND_IMGNAND) {
-            errorcode = WriteImageSectors(nand_buffer, sector + s, pcount);
-        } else if (nand_dst == NAND_SYSNAND) {
-            errorcode = sdmmc_nand_writesectors(sector + s, pcount, nand_buffer);
+    InvalidateNandBytesCache(sector, count, nand_dst);
+    if ((nand_dst == NAND_EMUNAND) && (sector == 0)) emunand_index.valid = false; // new header, rescan
+    if (crypto) {
+        if (nested) {
+            if (!(wbuf_alloc = AllocNandWriteBuffers(wbufs))) return -1;
         } else {
-            errorcode = -1;
+            if (!InitNandWriteBuffers()) return -1;
+            wbufs[0] = nand_wbuf[0];
+            wbufs[1] = nand_wbuf[1];
+            nand_wbuf_busy = true;
+        }
+    }
+    for (u32 s = 0, b = 0; s < count; s += (NAND_WRITE_CHUNK / 0x200), b ^= 1) {
+        u32 pcount = min((NAND_WRITE_CHUNK / 0x200), (count - s));
+        const u8* wbuf = buffer8 + (s * 0x200);
+        if (crypto) {
+            memcpy(wbufs[b], wbuf, pcount * 0x200);
+            if ((keyslot == 0x11) && (sector == SECTOR_SECRET)) CryptSector0x96(wbufs[b], true);
+            else CryptNand(wbufs[b], sector + s, pcount, keyslot);
+            wbuf = wbufs[b];
         }
+        if ((errorcode = sdmmc_wait()) != 0) break; // previous chunk
+        if ((errorcode = WriteNandChunk(wbuf, sector + s, pcount, nand_dst)) != 0) break;
     }
 
-    free(nand_buffer);
-    return errorcode;
+    int lasterror = sdmmc_wait(); // last chunk
+    if (crypto && !nested) nand_wbuf_busy = false;
+    free(wbuf_alloc);
+    return errorcode ? errorcode : lasterror;
 }
 
 u32 ValidateSecretSector(u8* sector)
@@ -541,7 +686,7 @@ bool CheckMultiEmuNand(void)
     return (emunand_min_sectors && (GetPartitionOffsetSector("0:") >= (u64) (align(emunand_min_sectors + 1, 0x2000) * 2)));
 }
 
-u32 AutoEmuNandBase(bool reset)
+static u32 ProbeEmuNandBase(bool reset)
 {
     if (!reset) {
         u32 last_valid = emunand_base_sector;
@@ -577,6 +722,53 @@ u32 AutoEmuNandBase(bool reset)
     return emunand_base_sector;
 }
 
+static void BuildEmuNandIndex(void)
+{
+    // follows the same sparse probe sequence as ProbeEmuNandBase() (legacy slots,
+    // then compact slots), but only once per SD card, results are kept in emunand_index
+    emunand_index.count = 0;
+    emunand_index.valid = true;
+    emunand_index.fat_offset = GetPartitionOffsetSector("0:");
+    if (sdmmc_get_cid(false, emunand_index.cid) != 0)
+        memset(emunand_index.cid, 0x00, sizeof(emunand_index.cid));
+
+    u32 base = ProbeEmuNandBase(true);
+    if (!GetNandSizeSectors(NAND_EMUNAND) || (GetNandPartitionInfo(NULL, NP_TYPE_NCSD, NP_SUBTYPE_CTR, 0, NAND_EMUNAND) != 0))
+        return; // no EmuNAND at all
+    while (emunand_index.count < EMUNAND_INDEX_MAX) {
+        emunand_index.base[emunand_index.count++] = base;
+        u32 next = ProbeEmuNandBase(false);
+        if (next <= base) break; // wrapped around to the default offset
+        base = next;
+    }
+}
+
+static bool CheckEmuNandIndex(void)
+{
+    u32 cid[4];
+    if (!emunand_index.valid) return false;
+    if (emunand_index.fat_offset != GetPartitionOffsetSector("0:")) return false;
+    if (sdmmc_get_cid(false, cid) != 0) return false;
+    return (memcmp(cid, emunand_index.cid, sizeof(cid)) == 0);
+}
+
+u32 AutoEmuNandBase(bool reset)
+{
+    if (reset && !CheckEmuNandIndex()) BuildEmuNandIndex();
+    InvalidateNandBytesCache(0, UINT32_MAX, NAND_EMUNAND);
+
+    if (!emunand_index.valid) return ProbeEmuNandBase(reset); // index is outdated
+    if (!emunand_index.count) return (emunand_base_sector = 0x000001); // nothing found, default
+    if (reset) return (emunand_base_sector = emunand_index.base[0]);
+
+    // switch to the next known EmuNAND, probe if the current one is not indexed
+    for (u32 i = 0; i < emunand_index.count; i++) {
+        if (emunand_index.base[i] != emunand_base_sector) continue;
+        return (emunand_base_sector = emunand_index.base[(i + 1) % emunand_index.count]);
+    }
+    return ProbeEmuNandBase(false);
+}
+
 u32 GetEmuNandBase(void)
 {
     return emunand_base_sector;
@@ -584,5 +776,6 @@ u32 GetEmuNandBase(void)
 
 u32 SetEmuNandBase(u32 base_sector)
 {
+    InvalidateNandBytesCache(0, UINT32_MAX, NAND_EMUNAND);
     return (emunand_base_sector = base_sector);
 }
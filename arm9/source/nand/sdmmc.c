@@ -26,14 +26,27 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "timer.h"
+#include "ndma.h"
 #include "sdmmc.h"
 
 #define DATA32_SUPPORT
 
 
+#ifdef SDMMC_NDMA
+// NDMA channel used for SD / eMMC FIFO transfers
+#define SDMMC_NDMA_CH             (1)
+#endif
+
+
 struct mmcdevice handleNAND;
 struct mmcdevice handleSD;
 
+// transfer started via one of the *_async() functions, finished by sdmmc_wait()
+static struct mmcdevice *pendingCtx = NULL;
+static u32 pendingCmd = 0;
+static bool pendingDma = false;
+static int pendingError = 0;
+
 mmcdevice *getMMCDevice(int drive)
 {
 	if(drive==0) return &handleNAND;
@@ -48,6 +61,7 @@ static int get_error(struct mmcdevice *ctx)
 
 static void set_target(struct mmcdevice *ctx)
 {
+	if(pendingCtx) sdmmc_wait(); // finish async transfer before switching / reprogramming
 	sdmmc_mask16(REG_SDPORTSEL,0x3,(u16)ctx->devicenumber);
 	setckl(ctx->clk);
 	if(ctx->SDOPT == 0)
@@ -60,18 +74,8 @@ static void set_target(struct mmcdevice *ctx)
 	}
 }
 
-static void sdmmc_send_command(struct mmcdevice *ctx, u32 cmd, u32 args)
+static void sdmmc_start_command(struct mmcdevice *ctx, u32 cmd, u32 args, bool dma)
 {
-	const bool getSDRESP = (cmd << 15) >> 31;
-	u16 flags = (cmd << 15) >> 31;
-	const bool readdata = cmd & 0x20000;
-	const bool writedata = cmd & 0x40000;
-
-	if(readdata || writedata)
-	{
-		flags |= TMIO_STAT0_DATAEND;
-	}
-
 	ctx->error = 0;
 	while((sdmmc_read16(REG_SDSTATUS1) & TMIO_STAT1_CMD_BUSY)); //mmc working?
 	sdmmc_write16(REG_SDIRMASK0,0);
@@ -79,9 +83,42 @@ static void sdmmc_send_command(struct mmcdevice *ctx, u32 cmd, u32 args)
 	sdmmc_write16(REG_SDSTATUS0,0);
 	sdmmc_write16(REG_SDSTATUS1,0);
 	sdmmc_mask16(REG_DATACTL32,0x1800,0x400); // Disable TX32RQ and RX32RDY IRQ. Clear fifo.
+#ifdef SDMMC_NDMA
+	if(dma)
+	{
+		// The TX32RQ / RX32RDY IRQ enables also raise the NDMA startup request.
+		// One logical NDMA block moves one full 0x200 byte FIFO.
+		const bool readdata = cmd & 0x20000;
+		u32 *fifo = (u32*)(SDMMC_BASE + REG_SDFIFO32);
+		REG_NDMA_CNT(SDMMC_NDMA_CH) = 0;
+		REG_NDMA_SRC(SDMMC_NDMA_CH) = readdata ? (u32)fifo : (u32)ctx->tData;
+		REG_NDMA_DST(SDMMC_NDMA_CH) = readdata ? (u32)ctx->rData : (u32)fifo;
+		REG_NDMA_TOTAL_CNT(SDMMC_NDMA_CH) = ctx->size / 4;
+		REG_NDMA_LOG_BLK_CNT(SDMMC_NDMA_CH) = 0x200 / 4;
+		REG_NDMA_INT_CNT(SDMMC_NDMA_CH) = 0;
+		REG_NDMA_CNT(SDMMC_NDMA_CH) = NDMA_ENABLE | NDMA_STARTUP_SDMMC | NDMA_BURST_WORDS(16) |
+			(readdata ? NDMA_SRC_UPDATE_FIXED : NDMA_DST_UPDATE_FIXED);
+		sdmmc_mask16(REG_DATACTL32, 0, readdata ? 0x800 : 0x1000);
+	}
+#else
+	(void) dma;
+#endif
 	sdmmc_write16(REG_SDCMDARG0,args &0xFFFF);
 	sdmmc_write16(REG_SDCMDARG1,args >> 16);
 	sdmmc_write16(REG_SDCMD,cmd &0xFFFF);
+}
+
+static void sdmmc_finish_command(struct mmcdevice *ctx, u32 cmd, bool dma)
+{
+	const bool getSDRESP = (cmd << 15) >> 31;
+	u16 flags = (cmd << 15) >> 31;
+	const bool readdata = (cmd & 0x20000) && !dma; // with NDMA, the FIFO is not touched here
+	const bool writedata = (cmd & 0x40000) && !dma;
+
+	if(cmd & (0x20000 | 0x40000))
+	{
+		flags |= TMIO_STAT0_DATAEND;
+	}
 
 	u32 size = ctx->size;
 	const u16 blkSize = sdmmc_read16(REG_SDBLKLEN32);
@@ -234,6 +271,15 @@ static void sdmmc_send_command(struct mmcdevice *ctx, u32 cmd, u32 args)
 				break;
 		}
 	}
+#ifdef SDMMC_NDMA
+	if(dma)
+	{
+		if(ctx->error & 4) REG_NDMA_CNT(SDMMC_NDMA_CH) = 0; // abort on controller error
+		while(REG_NDMA_CNT(SDMMC_NDMA_CH) & NDMA_ENABLE);
+		sdmmc_mask16(REG_DATACTL32, 0x1800, 0);
+		if(cmd & 0x20000) ARM_InvDC_Range(ctx->rData, ctx->size);
+	}
+#endif
 	ctx->stat0 = sdmmc_read16(REG_SDSTATUS0);
 	ctx->stat1 = sdmmc_read16(REG_SDSTATUS1);
 	sdmmc_write16(REG_SDSTATUS0,0);
@@ -248,6 +294,67 @@ static void sdmmc_send_command(struct mmcdevice *ctx, u32 cmd, u32 args)
 	}
 }
 
+static void sdmmc_send_command(struct mmcdevice *ctx, u32 cmd, u32 args)
+{
+	if(pendingCtx) sdmmc_wait(); // never interleave with an async transfer
+	sdmmc_start_command(ctx, cmd, args, false);
+	sdmmc_finish_command(ctx, cmd, false);
+}
+
+bool sdmmc_can_dma(const void *buf, u32 size)
+{
+#ifdef SDMMC_NDMA
+	// whole cache lines only, and only memory NDMA can reach (no TCMs)
+	u32 addr = (u32)buf;
+	if((addr | size) & 0x1F) return false;
+	return ((addr >= 0x08000000) && (addr + size <= 0x08100000)) || // ARM9 internal memory
+		((addr >= 0x20000000) && (addr + size <= 0x30000000)); // FCRAM
+#else
+	(void) buf;
+	(void) size;
+	return false;
+#endif
+}
+
+static void sdmmc_send_command_async(struct mmcdevice *ctx, u32 cmd, u32 args)
+{
+	const bool readdata = cmd & 0x20000;
+	const void *buf = readdata ? (const void*)ctx->rData : (const void*)ctx->tData;
+	const bool dma = sdmmc_can_dma(buf, ctx->size);
+
+	if(pendingCtx) sdmmc_wait();
+	pendingError = 0;
+	if(!dma) // no NDMA -> transfer synchronously, result is picked up by sdmmc_wait()
+	{
+		sdmmc_start_command(ctx, cmd, args, false);
+		sdmmc_finish_command(ctx, cmd, false);
+		pendingError = get_error(ctx);
+		return;
+	}
+
+	if(readdata) ARM_InvDC_Range(ctx->rData, ctx->size);
+	else ARM_WbDC_Range((void*)ctx->tData, ctx->size);
+	ARM_DSB();
+	pendingCtx = ctx;
+	pendingCmd = cmd;
+	pendingDma = true;
+	sdmmc_start_command(ctx, cmd, args, true);
+}
+
+int sdmmc_wait(void)
+{
+	int error = pendingError;
+	if(pendingCtx)
+	{
+		struct mmcdevice *ctx = pendingCtx;
+		pendingCtx = NULL;
+		sdmmc_finish_command(ctx, pendingCmd, pendingDma);
+		error = get_error(ctx);
+	}
+	pendingError = 0;
+	return error;
+}
+
 int sdmmc_sdcard_writesectors(u32 sector_no, u32 numsectors, const u8 *in)
 {
 	if(handleSD.isSDHC == 0) sector_no <<= 9;
@@ -314,6 +421,56 @@ int sdmmc_nand_writesectors(u32 sector_no, u32 numsectors, const u8 *in) //exper
 	return get_error(&handleNAND);
 }
 
+static void sdmmc_readsectors_async(struct mmcdevice *ctx, u32 sector_no, u32 numsectors, u8 *out)
+{
+	if(ctx->isSDHC == 0) sector_no <<= 9;
+	set_target(ctx);
+	sdmmc_write16(REG_SDSTOP,0x100);
+#ifdef DATA32_SUPPORT
+	sdmmc_write16(REG_SDBLKCOUNT32,numsectors);
+	sdmmc_write16(REG_SDBLKLEN32,0x200);
+#endif
+	sdmmc_write16(REG_SDBLKCOUNT,numsectors);
+	ctx->rData = out;
+	ctx->size = numsectors << 9;
+	sdmmc_send_command_async(ctx,0x33C12,sector_no);
+}
+
+static void sdmmc_writesectors_async(struct mmcdevice *ctx, u32 sector_no, u32 numsectors, const u8 *in)
+{
+	if(ctx->isSDHC == 0) sector_no <<= 9;
+	set_target(ctx);
+	sdmmc_write16(REG_SDSTOP,0x100);
+#ifdef DATA32_SUPPORT
+	sdmmc_write16(REG_SDBLKCOUNT32,numsectors);
+	sdmmc_write16(REG_SDBLKLEN32,0x200);
+#endif
+	sdmmc_write16(REG_SDBLKCOUNT,numsectors);
+	ctx->tData = in;
+	ctx->size = numsectors << 9;
+	sdmmc_send_command_async(ctx,0x52C19,sector_no);
+}
+
+void sdmmc_sdcard_readsectors_async(u32 sector_no, u32 numsectors, u8 *out)
+{
+	sdmmc_readsectors_async(&handleSD, sector_no, numsectors, out);
+}
+
+void sdmmc_nand_readsectors_async(u32 sector_no, u32 numsectors, u8 *out)
+{
+	sdmmc_readsectors_async(&handleNAND, sector_no, numsectors, out);
+}
+
+void sdmmc_sdcard_writesectors_async(u32 sector_no, u32 numsectors, const u8 *in)
+{
+	sdmmc_writesectors_async(&handleSD, sector_no, numsectors, in);
+}
+
+void sdmmc_nand_writesectors_async(u32 sector_no, u32 numsectors, const u8 *in)
+{
+	sdmmc_writesectors_async(&handleNAND, sector_no, numsectors, in);
+}
+
 static u32 sdmmc_calc_size(u8* csd, int type)
 {
   u32 result = 0;
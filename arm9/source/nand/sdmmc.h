@@ -132,6 +132,15 @@ extern "C" {
 	int sdmmc_nand_readsectors(u32 sector_no, u32 numsectors, u8 *out);
 	int sdmmc_nand_writesectors(u32 sector_no, u32 numsectors, const u8 *in);
 
+	// async transfers: start the transfer (via NDMA where possible), sdmmc_wait() finishes it
+	// and returns the error; without NDMA the transfer is done before returning
+	bool sdmmc_can_dma(const void *buf, u32 size);
+	void sdmmc_sdcard_readsectors_async(u32 sector_no, u32 numsectors, u8 *out);
+	void sdmmc_sdcard_writesectors_async(u32 sector_no, u32 numsectors, const u8 *in);
+	void sdmmc_nand_readsectors_async(u32 sector_no, u32 numsectors, u8 *out);
+	void sdmmc_nand_writesectors_async(u32 sector_no, u32 numsectors, const u8 *in);
+	int sdmmc_wait(void);
+
 	int sdmmc_get_cid(bool isNand, u32 *info);
 
 	mmcdevice *getMMCDevice(int drive);
@@ -0,0 +1,49 @@
+#include "common.h"
+#include "arm.h"
+
+#include "job.h"
+#include "pxi.h"
+#include "shmem.h"
+
+int JOB_Submit(u32 kernel, const void *src, u32 len, u32 arg)
+{
+	SystemJob *const ring = ARM_GetSHMEM()->jobRing;
+	u32 slot;
+
+	for (slot = 0; slot < SHMEM_JOB_SLOTS; slot++)
+		if (ring[slot].status == SHMEM_JOB_FREE) break;
+	if (slot >= SHMEM_JOB_SLOTS)
+		return -1;
+
+	ring[slot].kernel = kernel;
+	ring[slot].src = (u32) src;
+	ring[slot].len = len;
+	ring[slot].arg = arg;
+
+	// the ARM11 reads the source straight from FCRAM
+	ARM_WbDC_Range((void*) src, len);
+	ARM_DSB();
+
+	if (PXI_DoCMD(PXICMD_JOB_SUBMIT, &slot, 1) != 0)
+		return -1;
+
+	return (int) slot;
+}
+
+bool JOB_IsDone(int slot)
+{
+	return ARM_GetSHMEM()->jobRing[slot].status == SHMEM_JOB_DONE;
+}
+
+u32 JOB_Wait(int slot)
+{
+	SystemJob *job;
+	u32 result;
+
+	while (!JOB_IsDone(slot));
+
+	job = &(ARM_GetSHMEM()->jobRing[slot]);
+	result = job->result;
+	job->status = SHMEM_JOB_FREE;
+	return result;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "common.h"
+#include "shmem.h"
+
+// queues up a job on the ARM11, returns the job slot or -1 on failure
+// the source data must stay untouched until the job is finished
+int JOB_Submit(u32 kernel, const void *src, u32 len, u32 arg);
+
+// true if the job in the given slot has finished
+bool JOB_IsDone(int slot);
+
+// waits for the job to finish, releases the slot and returns the result
+u32 JOB_Wait(int slot);
@@ -2,11 +2,15 @@
 #include <stdlib.h>
 
 static size_t total_allocated = 0;
+static size_t total_allocs = 0;
+static unsigned long long total_alloc_bytes = 0;
 
 void* my_malloc(size_t size) {
     if (!size) return NULL; // nothing, return nothing
     void* ptr = (void*) malloc(sizeof(size_t) + size);
     if (ptr) total_allocated += size;
+    if (ptr) total_allocs++;
+    if (ptr) total_alloc_bytes += size;
     if (ptr) (*(size_t*) ptr) = size;
     return ptr ? (((char*) ptr) + sizeof(size_t)) : NULL;
 }
@@ -46,6 +50,14 @@ size_t mem_allocated(void) {
     return total_allocated;
 }
 
+size_t mem_alloc_count(void) {
+    return total_allocs;
+}
+
+unsigned long long mem_alloc_bytes(void) {
+    return total_alloc_bytes;
+}
+
 size_t my_malloc_test(void) {
     size_t add = 1024 * 1024;
     for (size_t s = add;; s += add) {
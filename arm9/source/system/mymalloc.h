@@ -6,4 +6,6 @@ void* my_malloc(size_t size);
 void *my_realloc(void *ptr, size_t new_size);
 void my_free(void* ptr);
 size_t mem_allocated(void);
+size_t mem_alloc_count(void);
+unsigned long long mem_alloc_bytes(void);
 size_t my_malloc_test(void);
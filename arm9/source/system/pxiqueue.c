@@ -0,0 +1,71 @@
+#include "common.h"
+#include "arm.h"
+
+#include "pxiqueue.h"
+#include "memmap.h"
+#include "pxi.h"
+#include "shmem.h"
+
+bool PXIQ_CanShare(const void *buf, u32 len)
+{
+	u32 addr = (u32) buf;
+
+	// the ARM11 can't see ARM9 internal memory
+	if ((addr < __FCRAM0_ADDR) || (addr + len > __FCRAM1_END) || (addr + len < addr))
+		return false;
+
+	// partial cache lines could clobber neighbouring data
+	return !(addr % PXIQ_LINE_SIZE) && !(len % PXIQ_LINE_SIZE);
+}
+
+u32 PXIQ_Queue(u32 cmd, const u32 *args, u32 argc, void *buf, u32 len)
+{
+	SystemSHMEM *shmem = ARM_GetSHMEM();
+	u32 head = shmem->cmdHead;
+	SystemCmd *desc;
+
+	// wait for a free descriptor
+	while ((head - ARM_GetSHMEM()->cmdDone) >= SHMEM_CMD_SLOTS);
+
+	desc = &(shmem->cmdRing[head % SHMEM_CMD_SLOTS]);
+	desc->cmd = cmd;
+	desc->argc = min(argc, SHMEM_CMD_ARGS);
+	for (u32 i = 0; i < desc->argc; i++)
+		desc->args[i] = args[i];
+	desc->buf = (u32) buf;
+	desc->len = buf ? len : 0;
+
+	if (buf) {
+		ARM_WbInvDC_Range(buf, len);
+		ARM_DSB();
+	}
+
+	shmem->cmdHead = head + 1;
+
+	// the ARM11 only needs a wakeup if it already ran dry,
+	// otherwise it picks up the new command by itself
+	if (ARM_GetSHMEM()->cmdDone == head)
+		PXI_DoCMD(PXICMD_CMDQ_KICK, NULL, 0);
+
+	return head;
+}
+
+bool PXIQ_IsDone(u32 token)
+{
+	return (s32) (ARM_GetSHMEM()->cmdDone - token) > 0;
+}
+
+u32 PXIQ_Wait(u32 token)
+{
+	SystemCmd *desc;
+
+	while (!PXIQ_IsDone(token));
+
+	desc = &(ARM_GetSHMEM()->cmdRing[token % SHMEM_CMD_SLOTS]);
+	if (desc->buf) {
+		ARM_InvDC_Range((void*) desc->buf, desc->len);
+		ARM_DSB();
+	}
+
+	return desc->reply;
+}
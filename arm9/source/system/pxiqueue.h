@@ -0,0 +1,21 @@
+#pragma once
+
+#include "common.h"
+#include "shmem.h"
+
+// ARM9 data cache line size, scatter buffers must be aligned to it
+#define PXIQ_LINE_SIZE  32
+
+// true if the buffer may be handed to the ARM11 as a scatter buffer
+bool PXIQ_CanShare(const void *buf, u32 len);
+
+// queues up a command, returns a completion token
+// buf (optional) replaces the shared data buffer and may be larger
+// at most SHMEM_CMD_SLOTS commands may be queued before waiting on the first
+u32 PXIQ_Queue(u32 cmd, const u32 *args, u32 argc, void *buf, u32 len);
+
+// true if the command with the given token has finished
+bool PXIQ_IsDone(u32 token);
+
+// waits for the command to finish and returns its reply
+u32 PXIQ_Wait(u32 token);
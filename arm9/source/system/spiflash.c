@@ -2,6 +2,8 @@
 #include "arm.h"
 #include "pxi.h"
 #include "shmem.h"
+#include "pxiqueue.h"
+#include "spiflash.h"
 
 bool spiflash_get_status(void)
 {
@@ -10,24 +12,36 @@ bool spiflash_get_status(void)
 
 bool spiflash_read(u32 offset, u32 size, u8 *buf)
 {
-	u32 *const dataBuffer = ARM_GetSHMEM()->dataBuffer.w;
+	u8 *const dataBuffer = ARM_GetSHMEM()->dataBuffer.b;
+	const u32 blksz = SPIFLASH_STREAM_BLKSZ;
+	u32 n_blocks, token[2];
 	u32 args[2];
 
-	while(size > 0) {
-		u32 blksz = min(size, SHMEM_BUFFER_SIZE);
-
+	// suitable buffers are filled by the ARM11 directly, in one go
+	if (PXIQ_CanShare(buf, size)) {
 		args[0] = offset;
-		args[1] = blksz;
-
-		PXI_DoCMD(PXICMD_NVRAM_READ, args, 2);
-		ARM_InvDC_Range(dataBuffer, blksz);
-		ARM_DSB();
-
-		memcpy(buf, dataBuffer, blksz);
+		args[1] = size;
+		PXIQ_Wait(PXIQ_Queue(PXICMD_NVRAM_READ, args, 2, buf, size));
+		return true;
+	}
 
-		buf += blksz;
-		size -= blksz;
-		offset += blksz;
+	// otherwise stream through both halves of the shared buffer,
+	// the ARM11 fills one half while the other one is copied out
+	n_blocks = (size + blksz - 1) / blksz;
+	for (u32 i = 0; i <= n_blocks; i++) {
+		if (i < n_blocks) {
+			args[0] = offset + (i * blksz);
+			args[1] = min(blksz, size - (i * blksz));
+			token[i & 1] = PXIQ_Queue(PXICMD_NVRAM_READ, args, 2,
+				dataBuffer + ((i & 1) * blksz), args[1]);
+		}
+
+		if (i > 0) {
+			u32 j = i - 1;
+			PXIQ_Wait(token[j & 1]);
+			memcpy(buf + (j * blksz), dataBuffer + ((j & 1) * blksz),
+				min(blksz, size - (j * blksz)));
+		}
 	}
 
 	return true;
@@ -21,9 +21,13 @@
 
 #include "arm.h"
 #include "pxi.h"
+#include "shmem.h"
 
 #define NVRAM_SIZE  0x20000 // 1 Mbit (128kiB)
 
+// block size for reads streamed through the shared buffer
+#define SPIFLASH_STREAM_BLKSZ   (SHMEM_BUFFER_SIZE / 2)
+
 // true if spiflash is installed, false otherwise
 bool spiflash_get_status(void);
 
@@ -33,6 +33,18 @@ XRQ_End:
 
 .section .text.xrqs
 IRQ_Handler:
+    @ IRQs are only ever enabled by the sampling profiler
+    @ hand the interrupted PC over, anything else is fatal
+    ldr sp, =(__STACK_ABT_TOP - __STACK_ABT_LEN / 2)
+    sub lr, lr, #4
+    stmfd sp!, {r0-r3, r12, lr}
+    mov r0, lr
+    bl PROF_Sample
+    cmp r0, #0
+    ldmfd sp!, {r0-r3, r12, lr}
+    movnes pc, lr         @ return from IRQ, restores CPSR
+
+    add lr, lr, #4
     TRAP_ENTRY 6
     b XRQ_Fatal
 
@@ -1,4 +1,5 @@
 #include "gameutil.h"
+#include "keydbutil.h"
 #include "nandcmac.h"
 #include "disadiff.h"
 #include "fsutil.h" // for TAD verification
@@ -11,6 +12,7 @@
 #include "unittype.h"
 #include "aes.h"
 #include "sha.h"
+#include "perf.h"
 
 // use NCCH crypto defines for everything
 #define CRYPTO_DECRYPT  NCCH_NOCRYPTO
@@ -19,6 +21,10 @@
 // partitionA path
 #define PART_PATH       "D:/partitionA.bin"
 
+// BOSS batch summary
+#define BOSS_REPORT_NAME        "boss_report.txt"
+#define BOSS_REPORT_LINE_LEN    (16 + 1 + 8 + 1 + 9 + 1 + 13 + 1 + 64 + 2)
+
 
 u32 GetCbcBlocks(FIL* file, void* buffer, u64 offset, u32 count, u8* titlekey, u8* forced_iv) {
     u8 iv[16] __attribute__((aligned(4)));
@@ -946,77 +952,121 @@ u32 VerifyFirmFile(const char* path) {
     return 0;
 }
 
-u32 VerifyBossFile(const char* path) {
-    BossHeader boss;
-    u32 payload_size;
-    bool encrypted = false;
-    FIL file;
-    UINT btr;
-
-    char pathstr[UTF_BUFFER_BYTESIZE(32)];
-    TruncateString(pathstr, path, 32, 8);
+typedef struct {
+    BossHeader header; // always decrypted
+    u8 hash[0x20]; // calculated payload hash
+    bool encrypted; // state of the original file
+} BossProcessInfo;
+
+// single pass BOSS processor, de-/encrypts and hashes the payload at once
+// dest == NULL -> hash only, dest == orig -> inplace (only written if crypto changes)
+u32 ProcessBossFileBuffered(const char* orig, const char* dest, bool encrypt, BossProcessInfo* info, u8* buffer) {
+    bool inplace = dest && (strncmp(orig, dest, 256) == 0);
+    BossHeader* boss = &(info->header);
+    FIL ofile;
+    FIL dfile;
+    FIL* ofp = &ofile;
+    FIL* dfp = (inplace) ? &ofile : &dfile;
+    UINT btr, btw;
 
-    // read file header
-    if (fvx_open(&file, path, FA_READ | FA_OPEN_EXISTING) != FR_OK)
+    // read and check file header
+    if (fvx_open(ofp, orig, (inplace ? FA_WRITE : 0) | FA_READ | FA_OPEN_EXISTING) != FR_OK)
         return 1;
-    fvx_lseek(&file, 0);
-    if ((fvx_read(&file, &boss, sizeof(BossHeader), &btr) != FR_OK) ||
-        (btr != sizeof(BossHeader)) || (ValidateBossHeader(&boss, 0) != 0)) {
-        ShowPrompt(false, "%s\n%s", pathstr, STR_ERROR_NOT_A_BOSS_FILE);
-        fvx_close(&file);
-        return 1;
-    }
-
-    // get / check size
-    payload_size = getbe32(boss.filesize) - sizeof(BossHeader);
-    if (!payload_size) {
-        fvx_close(&file);
+    if ((fvx_read(ofp, boss, sizeof(BossHeader), &btr) != FR_OK) || (btr != sizeof(BossHeader)) ||
+        (ValidateBossHeader(boss, 0) != 0) || (getbe32(boss->filesize) > fvx_size(ofp))) {
+        fvx_close(ofp);
         return 1;
     }
 
-    // check if encrypted, decrypt if required
-    encrypted = (CheckBossEncrypted(&boss) == 0);
-    if (encrypted) CryptBoss((void*) &boss, 0, sizeof(BossHeader), &boss);
+    // decrypt the header, find out what needs to be done
+    u32 payload_size = getbe32(boss->filesize) - sizeof(BossHeader);
+    info->encrypted = (CheckBossEncrypted(boss) == 0);
+    if (info->encrypted) CryptBoss((void*) boss, 0, sizeof(BossHeader), boss);
+    bool write = dest && (!inplace || (info->encrypted != encrypt));
+    bool crypt_out = write && encrypt;
 
-    // set up a buffer
-    u8* buffer = (u8*) malloc(STD_BUFFER_SIZE);
-    if (!buffer) {
-        fvx_close(&file);
-        return 1;
+    // open destination, write header
+    if (write) {
+        BossHeader boss_out;
+        memcpy(&boss_out, boss, sizeof(BossHeader));
+        if (crypt_out) CryptBoss((void*) &boss_out, 0, sizeof(BossHeader), &boss_out);
+        if ((!inplace && (fvx_open(dfp, dest, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK)) ||
+            (fvx_lseek(dfp, 0) != FR_OK) ||
+            (fvx_write(dfp, &boss_out, sizeof(BossHeader), &btw) != FR_OK) ||
+            (btw != sizeof(BossHeader))) {
+            fvx_close(ofp);
+            if (!inplace) fvx_close(dfp);
+            return 1;
+        }
     }
 
-    // actual hash calculation & compare
-    u8 hash[32];
+    // payload hash covers (part of) the payload header, too
+    // first chunk is shorter, so all chunks end up 64 byte aligned for the SHA engine
+    u32 ret = 0;
     sha_init(SHA256_MODE);
+    GetBossPayloadHashHeader(buffer, boss);
+    for (u32 i = 0, n = 0; (i < payload_size) && (ret == 0); i += n) {
+        u32 hdr_len = (i == 0) ? BOSS_SIZE_PAYLOAD_HEADER : 0;
+        u8* data = buffer + hdr_len;
+        n = min(STD_BUFFER_SIZE - hdr_len, payload_size - i);
+        if ((fvx_read(ofp, data, n, &btr) != FR_OK) || (btr != n)) ret = 1;
+        if (info->encrypted) CryptBoss(data, sizeof(BossHeader) + i, n, boss);
+        sha_update(buffer, n + hdr_len);
+        if (write) {
+            if (crypt_out) CryptBoss(data, sizeof(BossHeader) + i, n, boss);
+            if (inplace) fvx_lseek(ofp, fvx_tell(ofp) - n);
+            if ((fvx_write(dfp, data, n, &btw) != FR_OK) || (btw != n)) ret = 1;
+        }
+        if (!ShowProgress(i + n, payload_size, orig)) ret = 1;
+    }
+    sha_get(info->hash);
 
-    GetBossPayloadHashHeader(buffer, &boss);
-    u32 read_bytes = min((STD_BUFFER_SIZE - BOSS_SIZE_PAYLOAD_HEADER), payload_size);
-    fvx_read(&file, buffer + BOSS_SIZE_PAYLOAD_HEADER, read_bytes, &btr);
-    if (encrypted) CryptBoss(buffer + BOSS_SIZE_PAYLOAD_HEADER, sizeof(BossHeader), read_bytes, &boss);
-    sha_update(buffer, read_bytes + BOSS_SIZE_PAYLOAD_HEADER);
+    fvx_close(ofp);
+    if (write && !inplace) fvx_close(dfp);
 
-    for (u32 i = read_bytes; i < payload_size; i += STD_BUFFER_SIZE) {
-        read_bytes = min(STD_BUFFER_SIZE, (payload_size - i));
-        fvx_read(&file, buffer, read_bytes, &btr);
-        if (encrypted) CryptBoss(buffer, sizeof(BossHeader) + i, read_bytes, &boss);
-        sha_update(buffer, read_bytes);
+    return ret;
+}
+
+u32 VerifyBossFile(const char* path) {
+    BossProcessInfo* info = (BossProcessInfo*) malloc(sizeof(BossProcessInfo));
+    u8* buffer = (u8*) malloc(STD_BUFFER_SIZE);
+
+    char pathstr[UTF_BUFFER_BYTESIZE(32)];
+    TruncateString(pathstr, path, 32, 8);
+
+    if (!info || !buffer) {
+        if (info) free(info);
+        if (buffer) free(buffer);
+        return 1;
     }
 
-    sha_get(hash);
-    fvx_close(&file);
+    // read, decrypt and hash in a single pass
+    if (ProcessBossFileBuffered(path, NULL, false, info, buffer) != 0) {
+        ShowPrompt(false, "%s\n%s", pathstr, STR_ERROR_NOT_A_BOSS_FILE);
+        free(info);
+        free(buffer);
+        return 1;
+    }
     free(buffer);
 
-    if (memcmp(hash, boss.hash_payload, 0x20) != 0) {
+    BossHeader* boss = &(info->header);
+    if (memcmp(info->hash, boss->hash_payload, 0x20) != 0) {
         if (ShowPrompt(true, "%s\n%s", pathstr, STR_BOSS_PAYLOAD_HASH_MISMATCH_TRY_TO_FIX_IT)) {
             // fix hash, reencrypt BOSS header if required, write to file
-            memcpy(boss.hash_payload, hash, 0x20);
-            if (encrypted) CryptBoss((void*) &boss, 0, sizeof(BossHeader), &boss);
+            memcpy(boss->hash_payload, info->hash, 0x20);
+            if (info->encrypted) CryptBoss((void*) boss, 0, sizeof(BossHeader), boss);
             if (!CheckWritePermissions(path) ||
-                (fvx_qwrite(path, &boss, 0, sizeof(BossHeader), NULL) != FR_OK))
+                (fvx_qwrite(path, boss, 0, sizeof(BossHeader), NULL) != FR_OK)) {
+                free(info);
                 return 1;
-        } else return 1;
+            }
+        } else {
+            free(info);
+            return 1;
+        }
     }
 
+    free(info);
     return 0;
 }
 
@@ -1034,25 +1084,29 @@ u32 VerifyTicketFile(const char* path) {
 
 u32 VerifyGameFile(const char* path) {
     u64 filetype = IdentifyFileType(path);
+    u64 perf = timer_start();
+    u32 ret;
     if (filetype & GAME_CIA)
-        return VerifyCiaFile(path);
+        ret = VerifyCiaFile(path);
     else if (filetype & GAME_NCSD)
-        return VerifyNcsdFile(path);
+        ret = VerifyNcsdFile(path);
     else if (filetype & GAME_NCCH)
-        return VerifyNcchFile(path, 0, 0);
+        ret = VerifyNcchFile(path, 0, 0);
     else if (filetype & (GAME_TMD|GAME_CDNTMD|GAME_TWLTMD))
-        return VerifyTmdFile(path, filetype & (GAME_CDNTMD|GAME_TWLTMD));
+        ret = VerifyTmdFile(path, filetype & (GAME_CDNTMD|GAME_TWLTMD));
     else if (filetype & GAME_TIE)
-        return VerifyTieFile(path);
+        ret = VerifyTieFile(path);
     else if (filetype & GAME_TAD)
-        return VerifyTadFile(path);
+        ret = VerifyTadFile(path);
     else if (filetype & GAME_BOSS)
-        return VerifyBossFile(path);
+        ret = VerifyBossFile(path);
     else if (filetype & SYS_FIRM)
-        return VerifyFirmFile(path);
+        ret = VerifyFirmFile(path);
     else if (filetype & GAME_TICKET)
-        return VerifyTicketFile(path);
+        ret = VerifyTicketFile(path);
     else return 1;
+    PerfOpEnd(PERF_OP_VERIFY, perf);
+    return ret;
 }
 
 u32 CheckEncryptedNcchFile(const char* path, u32 offset) {
@@ -1148,8 +1202,7 @@ u32 CheckEncryptedBossFile(const char* path) {
     return CheckBossEncrypted(&boss);
 }
 
-u32 CheckEncryptedGameFile(const char* path) {
-    u64 filetype = IdentifyFileType(path);
+u32 CheckEncryptedGameFileType(const char* path, u64 filetype) {
     if (filetype & GAME_CIA)
         return CheckEncryptedCiaFile(path);
     else if (filetype & GAME_NCSD)
@@ -1165,8 +1218,51 @@ u32 CheckEncryptedGameFile(const char* path) {
     else return 1;
 }
 
-u32 CryptNcchNcsdBossFirmFile(const char* orig, const char* dest, u32 mode, u16 crypto,
-    u32 offset, u32 size, TmdContentChunk* chunk, const u8* titlekey) { // this line only for CIA contents
+u32 CheckEncryptedGameFile(const char* path) {
+    return CheckEncryptedGameFileType(path, IdentifyFileType(path));
+}
+
+u32 CheckFullyEncryptedNcsdFile(const char* path) {
+    NcsdHeader ncsd;
+    u32 n_encrypted = 0;
+
+    // load NCSD header
+    if (LoadNcsdHeader(&ncsd, path) != 0)
+        return 1;
+
+    // all NCSD contents have to be encrypted
+    for (u32 i = 0; i < 8; i++) {
+        NcchPartition* partition = ncsd.partitions + i;
+        u32 offset = partition->offset * NCSD_MEDIA_UNIT;
+        if (!partition->size) continue;
+        if (CheckEncryptedNcchFile(path, offset) != 0)
+            return 1;
+        n_encrypted++;
+    }
+
+    return (n_encrypted) ? 0 : 1;
+}
+
+u32 CheckCryptGameFile(const char* path, u64 filetype, bool encrypt) {
+    // header checks only, returns 0 if the file needs processing
+    if (filetype & BIN_KEYDB)
+        return 0; // always processed
+    if (!encrypt)
+        return CheckEncryptedGameFileType(path, filetype);
+    if (!FTYPE_ENCRYPTABLE(filetype))
+        return 1;
+    if (filetype & GAME_NCCH)
+        return (CheckEncryptedNcchFile(path, 0) == 0) ? 1 : 0;
+    if (filetype & GAME_NCSD)
+        return (CheckFullyEncryptedNcsdFile(path) == 0) ? 1 : 0;
+    if (filetype & GAME_BOSS)
+        return (CheckEncryptedBossFile(path) == 0) ? 1 : 0;
+    return 0; // CIA contents may be mixed, always processed
+}
+
+u32 CryptNcchNcsdBossFirmFileBuffered(const char* orig, const char* dest, u32 mode, u16 crypto,
+    u32 offset, u32 size, TmdContentChunk* chunk, const u8* titlekey, // this line only for CIA contents
+    u8* buffer) { // buffer has to be STD_BUFFER_SIZE
     // this will do a simple copy for unencrypted files
     bool inplace = (strncmp(orig, dest, 256) == 0);
     FIL ofile;
@@ -1214,14 +1310,6 @@ u32 CryptNcchNcsdBossFirmFile(const char* orig, const char* dest, u32 mode, u16
         }
     }
 
-    // set up buffer
-    u8* buffer = (u8*) malloc(STD_BUFFER_SIZE);
-    if (!buffer) {
-        fvx_close(ofp);
-        fvx_close(dfp);
-        return 1;
-    }
-
     u32 ret = 0;
     if (!ShowProgress(offset, fsize, dest)) ret = 1;
     if (mode & (GAME_NCCH|GAME_NCSD|GAME_BOSS|SYS_FIRM|GAME_NDS)) { // for NCCH / NCSD / BOSS / FIRM files
@@ -1273,12 +1361,22 @@ u32 CryptNcchNcsdBossFirmFile(const char* orig, const char* dest, u32 mode, u16
 
     fvx_close(ofp);
     if (!inplace) fvx_close(dfp);
-    if (buffer) free(buffer);
 
     return ret;
 }
 
-u32 CryptCiaFile(const char* orig, const char* dest, u16 crypto) {
+u32 CryptNcchNcsdBossFirmFile(const char* orig, const char* dest, u32 mode, u16 crypto,
+    u32 offset, u32 size, TmdContentChunk* chunk, const u8* titlekey) { // this line only for CIA contents
+    u8* buffer = (u8*) malloc(STD_BUFFER_SIZE);
+    if (!buffer) return 1;
+
+    u32 ret = CryptNcchNcsdBossFirmFileBuffered(orig, dest, mode, crypto, offset, size, chunk, titlekey, buffer);
+
+    free(buffer);
+    return ret;
+}
+
+u32 CryptCiaFileBuffered(const char* orig, const char* dest, u16 crypto, u8* buffer) {
     bool inplace = (strncmp(orig, dest, 256) == 0);
     CiaInfo info;
     u8 titlekey[16];
@@ -1308,7 +1406,7 @@ u32 CryptCiaFile(const char* orig, const char* dest, u16 crypto) {
         u64 size = getbe64(chunk->size);
         u16 index = getbe16(chunk->index);
         if (!(cnt_index[index/8] & (1 << (7-(index%8))))) continue; // don't crypt missing contents
-        if (CryptNcchNcsdBossFirmFile(orig, dest, GAME_CIA, crypto, next_offset, size, chunk, titlekey) != 0) {
+        if (CryptNcchNcsdBossFirmFileBuffered(orig, dest, GAME_CIA, crypto, next_offset, size, chunk, titlekey, buffer) != 0) {
             free(cia);
             return 1;
         }
@@ -1341,6 +1439,16 @@ u32 CryptCiaFile(const char* orig, const char* dest, u16 crypto) {
     return 0;
 }
 
+u32 CryptCiaFile(const char* orig, const char* dest, u16 crypto) {
+    u8* buffer = (u8*) malloc(STD_BUFFER_SIZE);
+    if (!buffer) return 1;
+
+    u32 ret = CryptCiaFileBuffered(orig, dest, crypto, buffer);
+
+    free(buffer);
+    return ret;
+}
+
 u32 DecryptFirmFile(const char* orig, const char* dest) {
     static const u8 dec_magic[] = { 'D', 'E', 'C', '\0' }; // insert to decrypted firms
     void* firm_buffer = (void*) malloc(FIRM_MAX_SIZE);
@@ -1449,8 +1557,8 @@ u32 CryptCdnFile(const char* orig, const char* dest, u16 crypto) {
     return ret;
 }
 
-u32 CryptGameFile(const char* path, bool inplace, bool encrypt) {
-    u64 filetype = IdentifyFileType(path);
+static u32 CryptGameFileBufferedInfo(const char* path, u64 filetype, bool inplace, bool encrypt, u8* buffer,
+    BossProcessInfo* boss_info) { // boss_info only used for BOSS files, may be NULL
     u16 crypto = encrypt ? CRYPTO_ENCRYPT : CRYPTO_DECRYPT;
     char dest[256];
     char* destptr = (char*) path;
@@ -1477,13 +1585,16 @@ u32 CryptGameFile(const char* path, bool inplace, bool encrypt) {
     }
 
     if (filetype & GAME_CIA)
-        ret = CryptCiaFile(path, destptr, crypto);
+        ret = CryptCiaFileBuffered(path, destptr, crypto, buffer);
     else if (filetype & GAME_NUSCDN)
         ret = CryptCdnFile(path, destptr, crypto);
     else if (filetype & SYS_FIRM)
         ret = DecryptFirmFile(path, destptr);
-    else if (filetype & (GAME_NCCH|GAME_NCSD|GAME_BOSS))
-        ret = CryptNcchNcsdBossFirmFile(path, destptr, filetype, crypto, 0, 0, NULL, NULL);
+    else if (filetype & GAME_BOSS) {
+        BossProcessInfo info;
+        ret = ProcessBossFileBuffered(path, destptr, encrypt, boss_info ? boss_info : &info, buffer);
+    } else if (filetype & (GAME_NCCH|GAME_NCSD))
+        ret = CryptNcchNcsdBossFirmFileBuffered(path, destptr, filetype, crypto, 0, 0, NULL, NULL, buffer);
     else ret = 1;
 
     if (!inplace && (ret != 0))
@@ -1492,6 +1603,108 @@ u32 CryptGameFile(const char* path, bool inplace, bool encrypt) {
     return ret;
 }
 
+u32 CryptGameFileBuffered(const char* path, u64 filetype, bool inplace, bool encrypt, u8* buffer) {
+    return CryptGameFileBufferedInfo(path, filetype, inplace, encrypt, buffer, NULL);
+}
+
+u32 CryptGameFile(const char* path, bool inplace, bool encrypt) {
+    u8* buffer = (u8*) malloc(STD_BUFFER_SIZE);
+    if (!buffer) return 1;
+
+    u32 ret = CryptGameFileBuffered(path, IdentifyFileType(path), inplace, encrypt, buffer);
+
+    free(buffer);
+    return ret;
+}
+
+u32 CryptBossFileBatchEntry(const char* path, bool inplace, bool encrypt, u8* buffer, char* report) {
+    BossProcessInfo info = { 0 }; // header stays zero if it could not be read
+    const char* name = strrchr(path, '/');
+    name = (name) ? name + 1 : path;
+
+    u32 ret = CryptGameFileBufferedInfo(path, GAME_BOSS, inplace, encrypt, buffer, &info);
+
+    // one line per file for the summary
+    if (report) {
+        bool hash_ok = (ret == 0) && (memcmp(info.hash, info.header.hash_payload, 0x20) == 0);
+        snprintf(report + strlen(report), BOSS_REPORT_LINE_LEN, "%016llX %08lX %s %s %.64s\n",
+            getbe64(info.header.programId), getbe32(info.header.ns_dataId),
+            (ret != 0) ? "failed" : (info.encrypted == encrypt) ? "unchanged" : encrypt ? "encrypted" : "decrypted",
+            (ret != 0) ? "-" : hash_ok ? "hash_ok" : "hash_mismatch", name);
+    }
+
+    return ret;
+}
+
+u32 CryptGameFileBatch(DirStruct* contents, u64 filetype, bool inplace, bool encrypt, u32* n_skipped, u32* n_other,
+    void (*draw)(DirStruct* contents, u32 cursor, u32* scroll), u32* cursor, u32* scroll) {
+    u32 n_success = 0;
+    *n_skipped = 0;
+    *n_other = 0;
+
+    // classify everything once, one header read per file
+    u64* types = (u64*) malloc(contents->n_entries * sizeof(u64));
+    if (!types) return 0;
+    IdentifyDirContents(contents, types, true);
+
+    // one buffer shared by all files
+    u8* buffer = NULL;
+    if (!(filetype & BIN_KEYDB) && !(buffer = (u8*) malloc(STD_BUFFER_SIZE))) {
+        free(types);
+        return 0;
+    }
+
+    // BOSS files (SpotPass cache) get a summary report
+    char* report = NULL;
+    if ((filetype & GAME_BOSS) && (report = (char*) malloc(contents->n_entries * BOSS_REPORT_LINE_LEN + 1)))
+        *report = '\0';
+
+    if (!inplace && (fvx_rmkdir(OUTPUT_PATH) != FR_OK)) {
+        if (report) free(report);
+        if (buffer) free(buffer);
+        free(types);
+        return 0;
+    }
+
+    for (u32 i = 0; i < contents->n_entries; i++) {
+        DirEntry* entry = &(contents->entry[i]);
+        if (!entry->marked) continue;
+        if (!(types[i] & filetype & TYPE_BASE)) {
+            (*n_other)++;
+            continue;
+        }
+        if ((inplace || !encrypt) &&
+            (CheckCryptGameFile(entry->path, types[i], encrypt) != 0)) {
+            (*n_skipped)++; // already in the target state
+            if (encrypt) entry->marked = false; // already encrypted counts as done
+            continue;
+        }
+        if (draw) draw(contents, (*cursor = i), scroll); // update the file list
+        u32 ret = (filetype & BIN_KEYDB) ? CryptAesKeyDb(entry->path, inplace, encrypt) :
+            (types[i] & GAME_BOSS) ? CryptBossFileBatchEntry(entry->path, inplace, encrypt, buffer, report) :
+            CryptGameFileBuffered(entry->path, types[i], inplace, encrypt, buffer);
+        if (ret == 0) n_success++;
+        else { // on failure: show error, continue
+            char lpathstr[UTF_BUFFER_BYTESIZE(32)];
+            TruncateString(lpathstr, entry->path, 32, 8);
+            if (ShowPrompt(true, "%s\n%s", lpathstr, encrypt ?
+                STR_ENCRYPTION_FAILED_CONTINUE : STR_DECRYPTION_FAILED_CONTINUE)) continue;
+            else break;
+        }
+        entry->marked = false;
+    }
+
+    if (report) {
+        if (*report && ((fvx_rmkdir(OUTPUT_PATH) != FR_OK) ||
+            (fvx_qwrite(OUTPUT_PATH "/" BOSS_REPORT_NAME, report, 0, strlen(report), NULL) != FR_OK)))
+            ShowPrompt(false, "%s\n%s", OUTPUT_PATH "/" BOSS_REPORT_NAME, STR_WRITING_BOSS_REPORT_FAILED);
+        free(report);
+    }
+    if (buffer) free(buffer);
+    free(types);
+    return n_success;
+}
+
 u32 GetInstallDataDrive(char* drv, u64 tid64, bool to_emunand) {
     // check the title id
     bool to_twl = ((tid64 >> 32) & 0x8000);
@@ -1611,12 +1824,7 @@ u32 CreateSaveData(const char* drv, u64 tid64, const char* name, u32 save_size,
     return 0;
 }
 
-u32 UninstallGameData(u64 tid64, bool remove_tie, bool remove_ticket, bool remove_save, bool from_emunand) {
-    char drv[3];
-
-    // check permissions for SysNAND (this includes everything we need)
-    if (!CheckWritePermissions(from_emunand ? "4:" : "1:")) return 1;
-
+static u32 RemoveInstallData(char* drv, u64 tid64, bool remove_save, bool from_emunand) {
     // determine the drive
     if (GetInstallDataDrive(drv, tid64, from_emunand) != 0) return 1;
 
@@ -1633,6 +1841,18 @@ u32 UninstallGameData(u64 tid64, bool remove_tie, bool remove_ticket, bool remov
     if (remove_save && ((*drv == '1') || (*drv == '4')))
         CreateSaveData(drv, tid64, NULL, 0, true);
 
+    return 0;
+}
+
+u32 UninstallGameData(u64 tid64, bool remove_tie, bool remove_ticket, bool remove_save, bool from_emunand) {
+    char drv[3];
+
+    // check permissions for SysNAND (this includes everything we need)
+    if (!CheckWritePermissions(from_emunand ? "4:" : "1:")) return 1;
+
+    // remove data path
+    if (RemoveInstallData(drv, tid64, remove_save, from_emunand) != 0) return 1;
+
     // remove titledb entry / ticket
     u32 ret = 0;
     if (remove_tie || remove_ticket) {
@@ -1691,6 +1911,133 @@ u32 UninstallGameDataTie(const char* path, bool remove_tie, bool remove_ticket,
     return UninstallGameData(tid64, remove_tie, remove_ticket, remove_save, from_emunand);
 }
 
+static u32 RemoveTitlesFromInstallDbs(const u64* tid64s, u32 n_titles, const char* dbname, bool from_emunand, bool* success) {
+    bool is_ticketdb = (strncasecmp(dbname, "ticket.db", 10) == 0);
+    u8* title_ids = (u8*) malloc(n_titles * 8);
+    u32* indices = (u32*) malloc(n_titles * sizeof(u32));
+    bool* done = (bool*) malloc(n_titles * sizeof(bool));
+    bool* removed = (bool*) malloc(n_titles * sizeof(bool));
+    u32 ret = 0;
+
+    if (!title_ids || !indices || !done || !removed) {
+        free(title_ids);
+        free(indices);
+        free(done);
+        free(removed);
+        return 1;
+    }
+
+    // titles are grouped by database, each database is mounted and rebuilt once
+    memset(done, 0, n_titles * sizeof(bool));
+    for (u32 i = 0; i < n_titles; i++) {
+        char path_db[256];
+        char drv[3];
+        u32 n_db = 0;
+
+        if (done[i]) continue;
+        if ((GetInstallDataDrive(drv, tid64s[i], from_emunand) != 0) ||
+            (GetInstallDbsPath(path_db, drv, dbname) != 0)) {
+            success[i] = false;
+            continue;
+        }
+
+        for (u32 j = i; j < n_titles; j++) {
+            char path_db_j[256];
+            if (done[j] || (GetInstallDataDrive(drv, tid64s[j], from_emunand) != 0) ||
+                (GetInstallDbsPath(path_db_j, drv, dbname) != 0) ||
+                (strncmp(path_db, path_db_j, 256) != 0)) continue;
+            for (u32 b = 0; b < 8; b++) // we need the big endian title ID
+                title_ids[(n_db * 8) + b] = (tid64s[j] >> ((7-b)*8)) & 0xFF;
+            indices[n_db++] = j;
+            done[j] = true;
+        }
+
+        if (!InitImgFS(path_db) ||
+            ((is_ticketdb ? RemoveTicketsFromDB(PART_PATH, title_ids, n_db, removed) :
+                RemoveTitleInfoEntriesFromDB(PART_PATH, title_ids, n_db, removed)) != 0)) {
+            memset(removed, 0, n_db * sizeof(bool));
+            ret = 1;
+        }
+
+        for (u32 j = 0; j < n_db; j++)
+            if (!removed[j]) success[indices[j]] = false;
+    }
+
+    free(title_ids);
+    free(indices);
+    free(done);
+    free(removed);
+    return ret;
+}
+
+u32 UninstallGameDataTieBatch(DirStruct* contents, u64 filetype, bool remove_tie, bool remove_ticket, bool remove_save) {
+    // same requirements as UninstallGameDataTie() for all marked ties
+    bool from_emunand = false;
+    u32 n_marked = 0;
+    u32 n_titles = 0;
+    u32 n_success = 0;
+
+    const char* mntpath = GetMountPath();
+    if (!mntpath) return 0;
+
+    // title.db from emunand?
+    if ((strncasecmp(mntpath, "B:/dbs/title.db", 16) == 0) ||
+        (strncasecmp(mntpath, "4:/dbs/title.db", 16) == 0))
+        from_emunand = true;
+
+    // check permissions for SysNAND (this includes everything we need)
+    if (!CheckWritePermissions(from_emunand ? "4:" : "1:")) return 0;
+
+    for (u32 i = 0; i < contents->n_entries; i++)
+        if (contents->entry[i].marked) n_marked++;
+
+    u64* tid64s = (u64*) malloc(n_marked * sizeof(u64));
+    bool* success = (bool*) malloc(n_marked * sizeof(bool));
+    if (!tid64s || !success) {
+        free(tid64s);
+        free(success);
+        return 0;
+    }
+
+    // remove title data first, one title at a time
+    for (u32 i = 0, n_processed = 0; i < contents->n_entries; i++) {
+        const char* path = contents->entry[i].path;
+        char drv[3];
+        u64 tid64;
+
+        if (!contents->entry[i].marked) continue;
+        if (!ShowProgress(n_processed++, n_marked, path)) break;
+        if (!(IdentifyFileType(path) & filetype & TYPE_BASE)) continue;
+        if (sscanf(path, "T:/%016llx", &tid64) != 1) continue;
+        if (RemoveInstallData(drv, tid64, remove_save, from_emunand) != 0) continue;
+
+        tid64s[n_titles] = tid64;
+        success[n_titles++] = true;
+    }
+
+    // then update the databases in one pass each
+    if (n_titles && (remove_tie || remove_ticket)) {
+        // ensure remounting the old mount path
+        char path_store[256] = { 0 };
+        char* path_bak = NULL;
+        strncpy(path_store, mntpath, 256);
+        if (*path_store) path_bak = path_store;
+
+        if (remove_ticket) RemoveTitlesFromInstallDbs(tid64s, n_titles, "ticket.db", from_emunand, success);
+        if (remove_tie) RemoveTitlesFromInstallDbs(tid64s, n_titles, "title.db", from_emunand, success);
+
+        // restore old mount path
+        InitImgFS(path_bak);
+    }
+
+    for (u32 i = 0; i < n_titles; i++)
+        if (success[i]) n_success++;
+
+    free(tid64s);
+    free(success);
+    return n_success;
+}
+
 u32 LoadEncryptedIconFromCiaTmd(const char* path, void* output, void* hdr, bool cia_meta) {
     u64 filetype = IdentifyFileType(path);
     u8 tik_data[16] __attribute__((aligned(32)));
@@ -2879,6 +3226,7 @@ u32 InstallGameFile(const char* path, bool to_emunand) {
     UninstallGameData(tid64, false, false, false, to_emunand);
 
     // install game file
+    u64 perf = timer_start();
     if (filetype & GAME_CIA)
         ret = InstallFromCiaFile(path, drv);
     else if (filetype & (GAME_CDNTMD|GAME_TWLTMD))
@@ -2890,6 +3238,7 @@ u32 InstallGameFile(const char* path, bool to_emunand) {
     else if ((filetype & GAME_NDS) && (filetype & FLAG_DSIW))
         ret = BuildInstallFromNdsFile(path, drv, true);
     else ret = 1;
+    PerfOpEnd(PERF_OP_INSTALL, perf);
 
     // cleanup on failed installs, but leave ticket and save untouched
     if (ret != 0) UninstallGameData(tid64, true, false, false, to_emunand);
@@ -3074,6 +3423,141 @@ u32 DumpTicketForGameFile(const char* path, bool force_legit) {
     return 0;
 }
 
+typedef struct {
+    bool force_legit;
+    FIL* bundle; // NULL -> one file per title
+    u8* known; // title id + ticket id of every ticket in the bundle
+    u32 n_known;
+    u32 max_known;
+    u32 n_total;
+    u32 n_processed;
+    u32 n_dumped;
+    u32 n_existing;
+    u32 n_filtered;
+} TicketDumpState;
+
+static bool IsKnownTicket(TicketDumpState* state, Ticket* ticket, bool add) {
+    for (u32 i = 0; i < state->n_known; i++) {
+        u8* known = state->known + (i * 16);
+        if ((memcmp(known, ticket->title_id, 8) == 0) && (memcmp(known + 8, ticket->ticket_id, 8) == 0))
+            return true;
+    }
+    if (!add) return false;
+    if (state->n_known >= state->max_known) {
+        u32 max_known = state->max_known ? state->max_known * 2 : 256;
+        u8* known = (u8*) realloc(state->known, max_known * 16);
+        if (!known) return false;
+        state->known = known;
+        state->max_known = max_known;
+    }
+    memcpy(state->known + (state->n_known * 16), ticket->title_id, 8);
+    memcpy(state->known + (state->n_known * 16) + 8, ticket->ticket_id, 8);
+    state->n_known++;
+    return false;
+}
+
+static u32 DumpTicketCallback(Ticket* ticket, void* userdata) {
+    TicketDumpState* state = (TicketDumpState*) userdata;
+    u32 ticket_size = GetTicketSize(ticket);
+    char dest[64];
+
+    snprintf(dest, sizeof(dest), "%016llX", getbe64(ticket->title_id));
+    if (!ShowProgress(state->n_processed++, state->n_total, dest))
+        return 1; // user abort
+
+    if ((ValidateTicket(ticket) != 0) ||
+        (state->force_legit && (ValidateTicketSignature(ticket) != 0))) {
+        state->n_filtered++;
+        return 0;
+    }
+
+    if (state->bundle) { // append to bundle, unless it is already in there
+        UINT bw;
+        if (IsKnownTicket(state, ticket, true)) {
+            state->n_existing++;
+            return 0;
+        }
+        if ((fvx_write(state->bundle, ticket, ticket_size, &bw) != FR_OK) || (bw != ticket_size))
+            return 1;
+    } else { // one file per title, skip identical existing files
+        FILINFO fno;
+        snprintf(dest, sizeof(dest), OUTPUT_PATH "/tickets/%016llX.tik", getbe64(ticket->title_id));
+        if ((fvx_stat(dest, &fno) == FR_OK) && (fno.fsize == ticket_size)) {
+            u8* data = (u8*) malloc(ticket_size);
+            bool same = data && (fvx_qread(dest, data, 0, ticket_size, NULL) == FR_OK) &&
+                (memcmp(data, ticket, ticket_size) == 0);
+            free(data);
+            if (same) {
+                state->n_existing++;
+                return 0;
+            }
+        }
+        f_unlink(dest);
+        if (fvx_qwrite(dest, ticket, 0, ticket_size, NULL) != FR_OK)
+            return 1;
+    }
+
+    state->n_dumped++;
+    return 0;
+}
+
+u32 DumpTicketsFromDB(const char* path, bool force_legit, bool bundle, u32* n_dumped, u32* n_existing, u32* n_filtered) {
+    const char* path_out = bundle ? OUTPUT_PATH "/tickets.bin" : OUTPUT_PATH "/tickets";
+    TicketDumpState state = { 0 };
+    FIL file;
+    u32 ret = 0;
+
+    // write permissions, output dir
+    if (!CheckWritePermissions(path_out) ||
+        (fvx_rmkdir(bundle ? OUTPUT_PATH : path_out) != FR_OK))
+        return 1;
+
+    // get number of tickets (for progress display)
+    char path_store[256] = { 0 };
+    char* path_bak = NULL;
+    strncpy(path_store, GetMountPath(), 256);
+    if (*path_store) path_bak = path_store;
+    if (!InitImgFS(path) || !(state.n_total = GetNumTickets(PART_PATH))) {
+        InitImgFS(path_bak);
+        return 1;
+    }
+
+    // open bundle, index the tickets that are already in there
+    state.force_legit = force_legit;
+    if (bundle) {
+        TicketMinimum tik;
+        UINT br;
+        u32 offset = 0;
+        if (fvx_open(&file, path_out, FA_READ | FA_WRITE | FA_OPEN_ALWAYS) != FR_OK) {
+            InitImgFS(path_bak);
+            return 1;
+        }
+        while ((fvx_lseek(&file, offset) == FR_OK) &&
+            (fvx_read(&file, &tik, TICKET_MINIMUM_SIZE, &br) == FR_OK) && (br == TICKET_MINIMUM_SIZE) &&
+            (ValidateTicket((Ticket*) &tik) == 0) && (offset + GetTicketSize((Ticket*) &tik) <= fvx_size(&file))) {
+            IsKnownTicket(&state, (Ticket*) &tik, true);
+            offset += GetTicketSize((Ticket*) &tik);
+        }
+        // anything after the last valid ticket gets overwritten
+        if ((fvx_lseek(&file, offset) != FR_OK) || (f_truncate(&file) != FR_OK))
+            ret = 1;
+        state.bundle = &file;
+    }
+
+    // one sequential pass through ticket.db
+    if ((ret == 0) && (ReadAllTicketsFromDB(PART_PATH, DumpTicketCallback, &state) != 0))
+        ret = 1;
+
+    if (bundle) fvx_close(&file);
+    free(state.known);
+    InitImgFS(path_bak);
+
+    if (n_dumped) *n_dumped = state.n_dumped;
+    if (n_existing) *n_existing = state.n_existing;
+    if (n_filtered) *n_filtered = state.n_filtered;
+    return ret;
+}
+
 // this has very limited uses right now
 u32 DumpCxiSrlFromTmdFile(const char* path) {
     u64 filetype = 0;
@@ -3248,10 +3732,30 @@ u32 CompressCode(const char* path, const char* path_out) {
     return 0;
 }
 
+// returns the length of buffer without trailing pad bytes
+// checks 16 byte at once, byte granularity only for the final refine
+static u32 GetUnpaddedLength(const u8* buffer, u32 len, u8 pad_byte) {
+    const u32 pad_word = pad_byte * 0x01010101;
+    u32 pos = len;
+
+    while ((pos % 0x10) && (buffer[pos-1] == pad_byte)) pos--;
+    if (pos % 0x10) return pos;
+
+    for (const u32* w = (const u32*) (const void*) (buffer + pos); pos; pos -= 0x10) {
+        w -= 4;
+        if ((w[0] ^ pad_word) | (w[1] ^ pad_word) | (w[2] ^ pad_word) | (w[3] ^ pad_word))
+            break;
+    }
+
+    while (pos && (buffer[pos-1] == pad_byte)) pos--;
+    return pos;
+}
+
 u64 GetAnyFileTrimmedSize(const char* path) {
+    const u32 chunk_min = 0x10000;
     u64 fsize = 0;
     u64 trimsize = 0;
-    u8 pad_byte = 0x7F; 
+    u8 pad_byte = 0x7F;
     FIL fp;
     UINT br;
 
@@ -3261,21 +3765,31 @@ u64 GetAnyFileTrimmedSize(const char* path) {
     fsize = fvx_size(&fp);
     u32 bufsize = min(STD_BUFFER_SIZE, fsize);
     u8* buffer = (u8*) malloc(bufsize);
-    if (!buffer) return 0;
+    if (!buffer) {
+        fvx_close(&fp);
+        return 0;
+    }
 
-    for (s64 pos = align(fsize, bufsize) - bufsize; (pos >= 0) && !trimsize; pos -= bufsize) {
-        if ((fvx_lseek(&fp, (UINT) pos) != FR_OK) ||
-            (fvx_read(&fp, buffer, bufsize, &br) != FR_OK) || !br) break;
+    // scan backwards, starting small and growing the chunk size
+    // files with little padding won't need a full buffer read
+    u32 chunk = min(chunk_min, bufsize);
+    for (u64 end = fsize; end && !trimsize; chunk = min(chunk << 1, bufsize)) {
+        u32 len = (end > chunk) ? chunk : end;
+        u64 pos = end - len;
+        if ((len > 0x200) && (pos % 0x200)) { // keep subsequent reads sector aligned
+            u32 adj = 0x200 - (pos % 0x200);
+            pos += adj;
+            len -= adj;
+        }
+        if ((fvx_lseek(&fp, (FSIZE_t) pos) != FR_OK) ||
+            (fvx_read(&fp, buffer, len, &br) != FR_OK) || (br != len)) break;
         if (pad_byte == 0x7F) { // start value
-            pad_byte = buffer[br-1];
+            pad_byte = buffer[len-1];
             if ((pad_byte != 0x00) && (pad_byte != 0xFF)) break;
         }
-        for (u8* b = buffer + (br-1); b >= buffer; b--) {
-            if (*b != pad_byte) {
-                trimsize = pos + (b-buffer) + 1;
-                break;
-            }
-        }
+        u32 unpadded = GetUnpaddedLength(buffer, len, pad_byte);
+        if (unpadded) trimsize = pos + unpadded;
+        end = pos;
     }
 
     fvx_close(&fp);
@@ -3340,7 +3854,7 @@ u32 TrimGameFile(const char* path) {
     FIL fp;
     if (fx_open(&fp, path, FA_WRITE | FA_OPEN_EXISTING) != FR_OK)
         return 1;
-    if ((f_lseek(&fp, (u32) trimsize) != FR_OK) || (f_truncate(&fp) != FR_OK)) {
+    if ((f_lseek(&fp, (FSIZE_t) trimsize) != FR_OK) || (f_truncate(&fp) != FR_OK)) {
         fx_close(&fp);
         return 1;
     }
@@ -3805,6 +4319,19 @@ u32 InjectHealthAndSafety(const char* path, const char* destdrv) {
     return ret;
 }
 
+typedef struct {
+    TitleKeysInfo* tik_info;
+    bool dec;
+} TitleKeyInfoState;
+
+static u32 AddTicketToInfoCallback(Ticket* ticket, void* userdata) {
+    TitleKeyInfoState* state = (TitleKeyInfoState*) userdata;
+    if (TIKDB_SIZE(state->tik_info) + 32 > STD_BUFFER_SIZE) return 0; // no error message
+    if (ValidateTicketSignature(ticket) == 0)
+        AddTicketToInfo(state->tik_info, ticket, state->dec); // ignore result
+    return 0;
+}
+
 u32 BuildTitleKeyInfo(const char* path, bool dec, bool dump) {
     static TitleKeysInfo* tik_info = NULL;
     const char* path_out = (dec) ? OUTPUT_PATH "/" TIKDB_NAME_DEC : OUTPUT_PATH "/" TIKDB_NAME_ENC;
@@ -3834,28 +4361,13 @@ u32 BuildTitleKeyInfo(const char* path, bool dec, bool dump) {
             return 1;
         }
     } else if (filetype & SYS_TICKDB) {
-        u32 num_entries = 0;
-        u8* title_ids = NULL;
-
-        if (!InitImgFS(path_in) || 
-            !(num_entries = GetNumTickets(PART_PATH)) ||
-            !(title_ids = (u8*) malloc(num_entries * 8)) ||
-            (ListTicketTitleIDs(PART_PATH, title_ids, num_entries) != 0)) {
-            free(title_ids);
+        // read and validate all tickets in one pass, add validated to info
+        TitleKeyInfoState state = { tik_info, dec };
+        if (!InitImgFS(path_in) ||
+            (ReadAllTicketsFromDB(PART_PATH, AddTicketToInfoCallback, &state) != 0)) {
             InitImgFS(NULL);
             return 1;
         }
-
-        // read and validate all tickets, add validated to info
-        for (u32 i = 0; i < num_entries; i++) {
-            Ticket* ticket;
-            if (ReadTicketFromDB(PART_PATH, title_ids + (i * 8), &ticket) != 0) continue;
-            if (ValidateTicketSignature(ticket) == 0)
-                AddTicketToInfo(tik_info, ticket, dec); // ignore result
-            free(ticket);
-        }
-        
-        free(title_ids);
         InitImgFS(NULL);
     } else if (filetype & BIN_TIKDB) {
         TitleKeysInfo* tik_info_merge = (TitleKeysInfo*) malloc(STD_BUFFER_SIZE);
@@ -1,15 +1,20 @@
 #pragma once
 
 #include "common.h"
+#include "fsdir.h"
 
 u32 VerifyGameFile(const char* path);
 u32 CheckEncryptedGameFile(const char* path);
 u32 CryptGameFile(const char* path, bool inplace, bool encrypt);
+u32 CheckCryptGameFile(const char* path, u64 filetype, bool encrypt);
+u32 CryptGameFileBatch(DirStruct* contents, u64 filetype, bool inplace, bool encrypt, u32* n_skipped, u32* n_other,
+    void (*draw)(DirStruct* contents, u32 cursor, u32* scroll), u32* cursor, u32* scroll);
 u32 BuildCiaFromGameFile(const char* path, bool force_legit);
 u32 InstallGameFile(const char* path, bool to_emunand);
 u32 InstallCifinishFile(const char* path, bool to_emunand);
 u32 InstallTicketFile(const char* path, bool to_emunand);
 u32 DumpTicketForGameFile(const char* path, bool force_legit);
+u32 DumpTicketsFromDB(const char* path, bool force_legit, bool bundle, u32* n_dumped, u32* n_existing, u32* n_filtered);
 u32 DumpCxiSrlFromGameFile(const char* path);
 u32 ExtractCodeFromCxiFile(const char* path, const char* path_out, char* extstr);
 u32 CompressCode(const char* path, const char* path_out);
@@ -19,6 +24,7 @@ u32 ShowGameFileIcon(const char* path, u16* screen);
 u32 ShowGameCheckerInfo(const char* path);
 u64 GetGameFileTitleId(const char* path);
 u32 UninstallGameDataTie(const char* path, bool remove_tie, bool remove_ticket, bool remove_save);
+u32 UninstallGameDataTieBatch(DirStruct* contents, u64 filetype, bool remove_tie, bool remove_ticket, bool remove_save);
 u32 GetTmdContentPath(char* path_content, const char* path_tmd);
 u32 GetTieContentPath(char* path_content, const char* path_tie);
 u32 BuildNcchInfoXorpads(const char* destdir, const char* path);
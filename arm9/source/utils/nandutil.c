@@ -130,48 +130,57 @@ u32 EmbedEssentialBackup(const char* path) {
     return 0;
 }
 
-u32 DumpGbaVcSavegameBuffered(const char* path, void* buffer) {
+u32 OpenAgbSaveSession(AgbSaveSession* session, const char* path, void* buffer) {
     AgbSaveHeader* agbsave = (AgbSaveHeader*) buffer;
     u8* savegame = (u8*) (agbsave + 1);
 
-    // read full AGBsave to memory
+    memset(session, 0, sizeof(AgbSaveSession));
+
+    // read full AGBsave to memory, parsed only once per session
     if ((fvx_qread(path, agbsave, 0, sizeof(AgbSaveHeader), NULL) != FR_OK) || (ValidateAgbSaveHeader(agbsave) != 0) ||
         (fvx_qread(path, savegame, sizeof(AgbSaveHeader), agbsave->save_size, NULL) != FR_OK)) return 1; // not a proper AGBSAVE file
 
+    strncpy(session->path, path, 255);
+    session->agbsave = agbsave;
+    return 0;
+}
+
+static void SwapAgbSaveEeprom(u8* savegame, u32 save_size, u32 swap_size) {
     // byteswap for eeprom type saves (512 byte / 8 kB)
-    if ((agbsave->save_size == GBASAVE_EEPROM_512) || (agbsave->save_size == GBASAVE_EEPROM_8K)) {
-        for (u8* ptr = savegame; (ptr - savegame) < (int) agbsave->save_size; ptr += 8)
+    if ((save_size == GBASAVE_EEPROM_512) || (save_size == GBASAVE_EEPROM_8K)) {
+        for (u8* ptr = savegame; (ptr - savegame) < (int) swap_size; ptr += 8)
             *(u64*) (void*) ptr = getbe64(ptr);
     }
+}
 
-    // ensure the output dir exists
-    if (fvx_rmkdir(OUTPUT_PATH) != FR_OK)
-        return 1;
-
-    // generate output path
+u32 DumpAgbSaveSession(AgbSaveSession* session, const char* path_out) {
+    AgbSaveHeader* agbsave = session->agbsave;
+    u8* savegame = (u8*) (agbsave + 1);
     char path_vcsav[64];
-    snprintf(path_vcsav, sizeof(path_vcsav), OUTPUT_PATH "/%016llX.gbavc.sav", agbsave->title_id);
-    if (fvx_qwrite(path_vcsav, savegame, 0, agbsave->save_size, NULL) != FR_OK) return 1; // write fail
 
-    return 0;
-}
+    if (!agbsave) return 1;
 
-u32 DumpGbaVcSavegame(const char* path) {
-    u8* buffer = (u8*) malloc(AGBSAVE_MAX_SIZE);
-    if (!buffer) {
-        ShowPrompt(false, "%s", STR_OUT_OF_MEMORY);
-        return 1;
+    // generate output path, ensure the output dir exists
+    if (!path_out) {
+        if (fvx_rmkdir(OUTPUT_PATH) != FR_OK) return 1;
+        snprintf(path_vcsav, sizeof(path_vcsav), OUTPUT_PATH "/%016llX.gbavc.sav", agbsave->title_id);
+        path_out = path_vcsav;
     }
 
-    u32 ret = DumpGbaVcSavegameBuffered(path, buffer);
-    free(buffer);
+    // swap for output, swap back so the session data stays intact
+    SwapAgbSaveEeprom(savegame, agbsave->save_size, agbsave->save_size);
+    u32 ret = (fvx_qwrite(path_out, savegame, 0, agbsave->save_size, NULL) == FR_OK) ? 0 : 1;
+    SwapAgbSaveEeprom(savegame, agbsave->save_size, agbsave->save_size);
+
     return ret;
 }
 
-u32 InjectGbaVcSavegameBuffered(const char* path, const char* path_vcsave, void* buffer) {
-    AgbSaveHeader* agbsave = (AgbSaveHeader*) buffer;
+u32 InjectAgbSaveSession(AgbSaveSession* session, const char* path_vcsave) {
+    AgbSaveHeader* agbsave = session->agbsave;
     u8* savegame = (u8*) (agbsave + 1);
 
+    if (!agbsave) return 1;
+
     // basic sanity checks for path_vcsave
     FILINFO fno;
     char* ext = strrchr(path_vcsave, '.');
@@ -180,20 +189,26 @@ u32 InjectGbaVcSavegameBuffered(const char* path, const char* path_vcsave, void*
     if ((fvx_stat(path_vcsave, &fno) != FR_OK) || (!GBASAVE_VALID(fno.fsize) && !GBASAVE_VALID(fno.fsize - 16)))
         return 1; // bad size
 
-    // read AGBsave header to memory
-    if ((fvx_qread(path, agbsave, 0, sizeof(AgbSaveHeader), NULL) != FR_OK) ||
-        (ValidateAgbSaveHeader(agbsave) != 0)) return 1; // not a proper header
-
     // read savegame to memory
     u32 inject_save_size = min(agbsave->save_size, fno.fsize);
     memset(savegame, 0xFF, agbsave->save_size); // pad with 0xFF
-    if (fvx_qread(path_vcsave, savegame, 0, inject_save_size, NULL) != FR_OK) return 1;
-
-    // byteswap for eeprom type saves (512 byte / 8 kB)
-    if ((agbsave->save_size == GBASAVE_EEPROM_512) || (agbsave->save_size == GBASAVE_EEPROM_8K)) {
-        for (u8* ptr = savegame; (ptr - savegame) < (int) inject_save_size; ptr += 8)
-            *(u64*) (void*) ptr = getbe64(ptr);
+    if (fvx_qread(path_vcsave, savegame, 0, inject_save_size, NULL) != FR_OK) {
+        session->agbsave = NULL; // savegame is garbage now, don't allow commit
+        return 1;
     }
+    SwapAgbSaveEeprom(savegame, agbsave->save_size, inject_save_size);
+
+    session->dirty = true;
+    return 0;
+}
+
+u32 CommitAgbSaveSession(AgbSaveSession* session) {
+    AgbSaveHeader* agbsave = session->agbsave;
+    const char* path = session->path;
+    FILINFO fno;
+
+    if (!agbsave) return 1;
+    if (!session->dirty) return 0; // nothing to do
 
     // fix CMAC for NAND partition, rewrite AGBSAVE file
     u32 data_size = sizeof(AgbSaveHeader) + agbsave->save_size;
@@ -218,27 +233,49 @@ u32 InjectGbaVcSavegameBuffered(const char* path, const char* path_vcsave, void*
             (agbsave->times_saved == agbsave_sd.times_saved))
             slot = data_size; // proper slot is bottom slot (otherwise it's the top slot)
 
-        // inject next slot
+        // inject next slot, the session buffer keeps the NAND header (retries must not count twice)
+        AgbSaveHeader agbsave_nand;
+        memcpy(&agbsave_nand, agbsave, sizeof(AgbSaveHeader));
         agbsave->times_saved++; // increase # of times saved
-        if (FixAgbSaveCmac(agbsave, NULL, path_sd) != 0) return 1;
-        if (fvx_qwrite(path_sd, agbsave, slot, data_size, NULL) != FR_OK) return 1; // write fail
+        u32 res = ((FixAgbSaveCmac(agbsave, NULL, path_sd) == 0) &&
+            (fvx_qwrite(path_sd, agbsave, slot, data_size, NULL) == FR_OK)) ? 0 : 1;
+        memcpy(agbsave, &agbsave_nand, sizeof(AgbSaveHeader));
+        if (res != 0) return 1; // write fail
     }
 
     // set CFG_BOOTENV to 0x7 so the save is taken over (not needed anymore)
     // https://www.3dbrew.org/wiki/CONFIG9_Registers#CFG9_BOOTENV
     // if (strncasecmp(path, "S:/agbsave.bin", 256) == 0) *(u32*) 0x10010000 = 0x7;
 
+    session->dirty = false;
     return 0;
 }
 
+u32 DumpGbaVcSavegame(const char* path) {
+    AgbSaveSession session;
+    u8* buffer = (u8*) malloc(AGBSAVE_MAX_SIZE);
+    if (!buffer) {
+        ShowPrompt(false, "%s", STR_OUT_OF_MEMORY);
+        return 1;
+    }
+
+    u32 ret = ((OpenAgbSaveSession(&session, path, buffer) == 0) &&
+        (DumpAgbSaveSession(&session, NULL) == 0)) ? 0 : 1;
+    free(buffer);
+    return ret;
+}
+
 u32 InjectGbaVcSavegame(const char* path, const char* path_vcsave) {
+    AgbSaveSession session;
     u8* buffer = (u8*) malloc(AGBSAVE_MAX_SIZE);
     if (!buffer) {
         ShowPrompt(false, "%s", STR_OUT_OF_MEMORY);
         return 1;
     }
 
-    u32 ret = InjectGbaVcSavegameBuffered(path, path_vcsave, buffer);
+    u32 ret = ((OpenAgbSaveSession(&session, path, buffer) == 0) &&
+        (InjectAgbSaveSession(&session, path_vcsave) == 0) &&
+        (CommitAgbSaveSession(&session) == 0)) ? 0 : 1;
     free(buffer);
     return ret;
 }
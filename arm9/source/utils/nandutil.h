@@ -1,6 +1,15 @@
 #pragma once
 
 #include "common.h"
+#include "gba.h"
+
+// AGBSAVE session, header and savegame are parsed once and kept in memory
+// (buffer has to be AGBSAVE_MAX_SIZE), CMACs are only fixed at commit
+typedef struct {
+    char path[256];
+    AgbSaveHeader* agbsave;
+    bool dirty;
+} AgbSaveSession;
 
 u32 CheckEmbeddedBackup(const char* path);
 u32 EmbedEssentialBackup(const char* path);
@@ -11,3 +20,7 @@ u32 SafeInstallFirm(const char* path, u32 slots);
 u32 SafeInstallKeyDb(const char* path);
 u32 DumpGbaVcSavegame(const char* path);
 u32 InjectGbaVcSavegame(const char* path, const char* path_vcsave);
+u32 OpenAgbSaveSession(AgbSaveSession* session, const char* path, void* buffer);
+u32 DumpAgbSaveSession(AgbSaveSession* session, const char* path_out);
+u32 InjectAgbSaveSession(AgbSaveSession* session, const char* path_vcsave);
+u32 CommitAgbSaveSession(AgbSaveSession* session);
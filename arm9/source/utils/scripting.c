@@ -18,6 +18,8 @@
 #include "ips.h"
 #include "bps.h"
 #include "pxi.h"
+#include "trace.h"
+#include "profiler.h"
 
 
 #define _MAX_ARGS       4
@@ -127,6 +129,11 @@ typedef enum {
     CMD_ID_NEXTEMU,
     CMD_ID_REBOOT,
     CMD_ID_POWEROFF,
+    CMD_ID_TRACEDUMP,
+    CMD_ID_RESLOG,
+    #ifdef PROFILER
+    CMD_ID_PROFILE,
+    #endif
     CMD_ID_BKPT
 } cmd_id;
 
@@ -202,6 +209,11 @@ static const Gm9ScriptCmd cmd_list[] = {
     { CMD_ID_NEXTEMU , "nextemu" , 0, 0 },
     { CMD_ID_REBOOT  , "reboot"  , 0, 0 },
     { CMD_ID_POWEROFF, "poweroff", 0, 0 },
+    { CMD_ID_TRACEDUMP,"tracedump",0, 0 },
+    { CMD_ID_RESLOG  , "reslog"  , 1, 0 }, // results of game file commands -> JSON lines
+    #ifdef PROFILER
+    { CMD_ID_PROFILE , "profile" , 1, 0 }, // start / stop (stop also dumps)
+    #endif
     { CMD_ID_BKPT    , "bkpt"    , 0, 0 }
 };
 
@@ -222,6 +234,9 @@ static u32 ifcnt = 0;               // current # of 'if' nesting
 static void* script_buffer = NULL;
 static void* var_buffer = NULL;
 
+// results log for game file commands (empty -> off)
+static char reslog_path[256] = { 0 };
+
 
 static inline bool isntrboot(void) {
     // taken over from Luma 3DS:
@@ -859,6 +874,15 @@ bool parse_line(const char* line_start, const char* line_end, cmd_id* cmdid, u32
     return false;
 }
 
+void log_result(const char* cmd, const char* path, bool result) {
+    // paths can't contain '"' or '\\' on any of our drives, so no escaping needed
+    char line[_ARG_MAX_LEN + 64];
+    u32 len = snprintf(line, sizeof(line), "{\"cmd\":\"%s\",\"path\":\"%s\",\"ok\":%s}\n",
+        cmd, path, result ? "true" : "false");
+    if (len >= sizeof(line)) return;
+    FileSetData(reslog_path, line, len, FileGetSize(reslog_path), false);
+}
+
 bool run_cmd(cmd_id id, u32 flags, char** argv, char* err_str) {
     bool ret = true; // true unless some cmd messes up
 
@@ -1537,6 +1561,22 @@ bool run_cmd(cmd_id id, u32 flags, char** argv, char* err_str) {
         DeinitSDCardFS();
         PowerOff();
     }
+    else if (id == CMD_ID_TRACEDUMP) {
+        ret = (TraceFlush() == 0);
+        if (!ret && err_str) snprintf(err_str, _ERR_STR_LEN, "%s", STR_SCRIPTERR_WRITE_FAIL);
+    }
+    else if (id == CMD_ID_RESLOG) {
+        strncpy(reslog_path, argv[0], 256);
+        reslog_path[255] = '\0';
+    }
+    #ifdef PROFILER
+    else if (id == CMD_ID_PROFILE) {
+        if (strncasecmp(argv[0], "start", _ARG_MAX_LEN) == 0) ret = PROF_Start();
+        else if (strncasecmp(argv[0], "stop", _ARG_MAX_LEN) == 0) ret = (PROF_Dump() == 0);
+        else ret = false;
+        if (!ret && err_str) snprintf(err_str, _ERR_STR_LEN, "%s", STR_SCRIPTERR_WRITE_FAIL);
+    }
+    #endif
     else if (id == CMD_ID_BKPT) {
         bkpt;
         while(1);
@@ -1546,6 +1586,9 @@ bool run_cmd(cmd_id id, u32 flags, char** argv, char* err_str) {
         if (err_str) snprintf(err_str, _ERR_STR_LEN, "%s", STR_SCRIPTERR_UNKNOWN_ERROR);
     }
 
+    if (*reslog_path && (id >= CMD_ID_FIXCMAC) && (id <= CMD_ID_APPLYBPM))
+        log_result(cmd_list[id].cmd, argv[0], ret);
+
     if (ret && err_str) snprintf(err_str, _ERR_STR_LEN, "%s", STR_SCRIPTERR_COMMAND_SUCCESS);
     return ret;
 }
@@ -1602,10 +1645,16 @@ bool run_line(const char* line_start, const char* line_end, u32* flags, char* er
     }
 
     // run the command (if available)
-    if (cmdid && !run_cmd(cmdid, *flags, argv, err_str)) {
-        char* msg_fail = get_var("ERRORMSG", NULL);
-        if (msg_fail && *msg_fail) *err_str = '\0'; // use custom error message
-        return false;
+    if (cmdid) {
+        const char* cmd_name = (cmdid < countof(cmd_list)) ? cmd_list[cmdid].cmd : NULL;
+        TraceEvent(TRACE_EV_SCRIPT_START, cmdid, *flags, cmd_name);
+        bool cmd_ret = run_cmd(cmdid, *flags, argv, err_str);
+        TraceEvent(TRACE_EV_SCRIPT_END, cmdid, cmd_ret, cmd_name);
+        if (!cmd_ret) {
+            char* msg_fail = get_var("ERRORMSG", NULL);
+            if (msg_fail && *msg_fail) *err_str = '\0'; // use custom error message
+            return false;
+        }
     }
 
     // success if we arrive here
@@ -1874,6 +1923,7 @@ bool ExecuteGM9Script(const char* path_script) {
     for_ptr = NULL;
     skip_state = 0;
     syntax_error = false;
+    *reslog_path = '\0';
 
 
     // allocate && check memory
@@ -2011,6 +2061,7 @@ bool ExecuteGM9Script(const char* path_script) {
         if (!result) { // error handling
             if (syntax_error) // severe error, can't continue
                 flags &= ~(_FLG('o')|_FLG('s')); // never silent or optional
+            if (!(flags & _FLG('o'))) TraceFlush(); // keep a trace of what led up to this
 
             if (!(flags & _FLG('s'))) { // not silent
                 if (!*err_str) {
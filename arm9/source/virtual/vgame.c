@@ -93,20 +93,30 @@ static int n_templates_ncch  = -1;
 static int n_templates_exefs = -1;
 static int n_templates_nds   = -1;
 
-static u64 offset_firm  = (u64) -1;
-static u64 offset_a9bin = (u64) -1;
-static u64 offset_cia   = (u64) -1;
-static u64 offset_ncsd  = (u64) -1;
-static u64 offset_ncch  = (u64) -1;
-static u64 offset_exefs = (u64) -1;
-static u64 offset_romfs = (u64) -1;
-static u64 offset_lv3   = (u64) -1;
-static u64 offset_lv3fd = (u64) -1;
-static u64 offset_nds   = (u64) -1;
-static u64 offset_nitro = (u64) -1;
-static u64 offset_ccnt  = (u64) -1;
-static u64 offset_tad   = (u64) -1;
-static u32 index_ccnt   = (u32) -1;
+// offsets of the currently set up layers inside the mounted image, all -1 if unset
+typedef struct {
+    u64 firm;
+    u64 a9bin;
+    u64 cia;
+    u64 ncsd;
+    u64 ncch;
+    u64 exefs;
+    u64 romfs;
+    u64 lv3;
+    u64 lv3fd;
+    u64 nds;
+    u64 nitro;
+    u64 ccnt;
+    u64 tad;
+    u32 index_ccnt;
+} VGameOffsets;
+
+#define VGAME_NCCH_MEMO     8
+#define VGAME_ROMFS_MEMO    2
+
+static VGameOffsets offs = { .firm = (u64) -1, .a9bin = (u64) -1, .cia = (u64) -1, .ncsd = (u64) -1,
+    .ncch = (u64) -1, .exefs = (u64) -1, .romfs = (u64) -1, .lv3 = (u64) -1, .lv3fd = (u64) -1,
+    .nds = (u64) -1, .nitro = (u64) -1, .ccnt = (u64) -1, .tad = (u64) -1, .index_ccnt = (u32) -1 };
 
 // static CiaStub* cia       = NULL; *unused*
 static TwlHeader* twl     = NULL;
@@ -118,14 +128,51 @@ static ExeFsHeader* exefs = NULL;
 static RomFsLv3Index lv3idx;
 static u8 cia_titlekey[16];
 
+// crypto regions of the current NCCH, rebuilt when offs.ncch / offs.exefs change
+static NcchCryptMap ncch_map;
+static u64 ncch_map_offs[2] = { (u64) -1, (u64) -1 };
+
+// memoized NCCH / ExeFS levels, so going back to an NCCH seen before doesn't reparse it
+typedef struct {
+    u64 offset_ncch; // -1 -> unused
+    u64 offset_exefs;
+    int n_templates_ncch;
+    int n_templates_exefs;
+    u8 ncch[0x200];
+    u8 exefs[0x200];
+    u8 templates_ncch[0x400];
+    u8 templates_exefs[0x400];
+} VGameNcchMemo;
+
+// memoized RomFS levels (lv3 metadata + index), the buffer is owned by the memo
+typedef struct {
+    u64 offset_romfs; // -1 -> unused
+    u64 offset_lv3;
+    u64 offset_lv3fd;
+    u8* fs_buffer;
+    RomFsLv3Index lv3idx;
+} VGameRomFsMemo;
+
+static VGameNcchMemo* ncch_memo = NULL; // VGAME_NCCH_MEMO entries inside vgame_buffer
+static VGameRomFsMemo romfs_memo[VGAME_ROMFS_MEMO];
+static u32 ncch_memo_next = 0;
+static u32 romfs_memo_next = 0;
+
+// last ciphertext block of the previous CBC read, IV for a sequential next read
+static u8 cbc_next_iv[AES_BLOCK_SIZE] __attribute__((aligned(4)));
+static u64 cbc_next_block = (u64) -1;
+
 
 int ReadCbcImageBlocks(void* buffer, u64 block, u64 count, u8* iv0, u64 block0) {
     int ret = ReadImageBytes(buffer, block * AES_BLOCK_SIZE, count * AES_BLOCK_SIZE);
-    if ((ret == 0) && iv0) {
+    if ((ret == 0) && iv0 && count) {
         u8 ctr[AES_BLOCK_SIZE] = { 0 };
         if (block == block0) memcpy(ctr, iv0, AES_BLOCK_SIZE);
+        else if (block == cbc_next_block) memcpy(ctr, cbc_next_iv, AES_BLOCK_SIZE);
         else if ((ret = ReadImageBytes(ctr, (block-1) * AES_BLOCK_SIZE, AES_BLOCK_SIZE)) != 0)
             return ret;
+        memcpy(cbc_next_iv, (u8*) buffer + ((count-1) * AES_BLOCK_SIZE), AES_BLOCK_SIZE);
+        cbc_next_block = block + count;
 
         u32 mode = AES_CNT_TITLEKEY_DECRYPT_MODE;
         cbc_decrypt(buffer, buffer, count, mode, ctr);
@@ -187,21 +234,97 @@ int ReadCiaContentImageBytes(void* buffer, u64 offset, u64 count, u32 cia_cnt_id
 }
 
 int ReadGameImageBytes(void* buffer, u64 offset, u64 count) {
-    int ret = ((offset_ccnt != (u64) -1) && (index_ccnt <= 0xFFFF)) ?
-        ReadCiaContentImageBytes(buffer, offset, count, index_ccnt, offset_ccnt) :
+    int ret = ((offs.ccnt != (u64) -1) && (offs.index_ccnt <= 0xFFFF)) ?
+        ReadCiaContentImageBytes(buffer, offset, count, offs.index_ccnt, offs.ccnt) :
         ReadImageBytes(buffer, offset, count);
-    if ((offset_a9bin != (u64) -1) && (DecryptFirm(buffer, offset, count, firm, a9l) != 0))
+    if ((offs.a9bin != (u64) -1) && (DecryptFirm(buffer, offset, count, firm, a9l) != 0))
         return -1;
     return ret;
 }
 
 int ReadNcchImageBytes(void* buffer, u64 offset, u64 count) {
     int ret = ReadGameImageBytes(buffer, offset, count);
-    if ((offset_ncch != (u64) -1) && NCCH_ENCRYPTED(ncch) && (DecryptNcch(buffer, offset - offset_ncch, count,
-        ncch, (offset_exefs == (u64) -1) ? NULL : exefs) != 0)) return -1;
+    if ((offs.ncch == (u64) -1) || !NCCH_ENCRYPTED(ncch)) return ret;
+    if ((ncch_map_offs[0] != offs.ncch) || (ncch_map_offs[1] != offs.exefs)) {
+        if (BuildNcchCryptMap(&ncch_map, ncch, (offs.exefs == (u64) -1) ? NULL : exefs) != 0) return -1;
+        ncch_map_offs[0] = offs.ncch;
+        ncch_map_offs[1] = offs.exefs;
+    }
+    if (CryptNcchMapped(buffer, offset - offs.ncch, count, ncch, &ncch_map, NCCH_NOCRYPTO) != 0)
+        return -1;
     return ret;
 }
 
+static void MemoVGameNcch(void) {
+    VGameNcchMemo* memo = ncch_memo + ncch_memo_next;
+    ncch_memo_next = (ncch_memo_next + 1) % VGAME_NCCH_MEMO;
+    memo->offset_ncch = offs.ncch;
+    memo->offset_exefs = offs.exefs;
+    memo->n_templates_ncch = n_templates_ncch;
+    memo->n_templates_exefs = n_templates_exefs;
+    memcpy(memo->ncch, ncch, 0x200);
+    memcpy(memo->exefs, exefs, 0x200);
+    memcpy(memo->templates_ncch, templates_ncch, 0x400);
+    memcpy(memo->templates_exefs, templates_exefs, 0x400);
+}
+
+static bool RestoreVGameNcch(u64 offset) {
+    for (u32 i = 0; i < VGAME_NCCH_MEMO; i++) {
+        VGameNcchMemo* memo = ncch_memo + i;
+        if (memo->offset_ncch != offset) continue;
+        memcpy(ncch, memo->ncch, 0x200);
+        memcpy(exefs, memo->exefs, 0x200);
+        memcpy(templates_ncch, memo->templates_ncch, 0x400);
+        memcpy(templates_exefs, memo->templates_exefs, 0x400);
+        n_templates_ncch = memo->n_templates_ncch;
+        n_templates_exefs = memo->n_templates_exefs;
+        offs.ncch = memo->offset_ncch;
+        offs.exefs = memo->offset_exefs;
+        return true;
+    }
+    return false;
+}
+
+static void ParkVGameRomFs(void) {
+    // hand the current RomFS buffer over to the memo (evicting the oldest entry)
+    if ((offs.romfs == (u64) -1) || !vgame_fs_buffer) return;
+    VGameRomFsMemo* memo = romfs_memo + romfs_memo_next;
+    romfs_memo_next = (romfs_memo_next + 1) % VGAME_ROMFS_MEMO;
+    if (memo->fs_buffer) free(memo->fs_buffer);
+    memo->offset_romfs = offs.romfs;
+    memo->offset_lv3 = offs.lv3;
+    memo->offset_lv3fd = offs.lv3fd;
+    memo->fs_buffer = vgame_fs_buffer;
+    memcpy(&(memo->lv3idx), &lv3idx, sizeof(RomFsLv3Index));
+    vgame_fs_buffer = NULL;
+    offs.romfs = (u64) -1;
+}
+
+static bool RestoreVGameRomFs(u64 offset) {
+    for (u32 i = 0; i < VGAME_ROMFS_MEMO; i++) {
+        VGameRomFsMemo* memo = romfs_memo + i;
+        if ((memo->offset_romfs != offset) || !memo->fs_buffer) continue;
+        if (vgame_fs_buffer) free(vgame_fs_buffer);
+        vgame_fs_buffer = memo->fs_buffer;
+        memcpy(&lv3idx, &(memo->lv3idx), sizeof(RomFsLv3Index));
+        offs.romfs = memo->offset_romfs;
+        offs.lv3 = memo->offset_lv3;
+        offs.lv3fd = memo->offset_lv3fd;
+        memo->offset_romfs = (u64) -1;
+        memo->fs_buffer = NULL;
+        return true;
+    }
+    return false;
+}
+
+static bool SwitchVGameRomFs(u64 offset) {
+    // park the current RomFS, then try to take the new one from the memo
+    ParkVGameRomFs();
+    if (!RestoreVGameRomFs(offset)) return false;
+    offs.nitro = (u64) -1; // mutually exclusive
+    return true;
+}
+
 bool BuildVGameExeFsDir(void) {
     VirtualFile* templates = templates_exefs;
     u32 n = 0;
@@ -210,9 +333,9 @@ bool BuildVGameExeFsDir(void) {
         ExeFsFileHeader* file = exefs->files + i;
         if (file->size == 0) continue;
         snprintf(templates[n].name, 32, "%.8s", file->name);
-        templates[n].offset = offset_exefs + sizeof(ExeFsHeader) + file->offset;
+        templates[n].offset = offs.exefs + sizeof(ExeFsHeader) + file->offset;
         templates[n].size = file->size;
-        templates[n].keyslot = ((offset_ncch != (u64) -1) && NCCH_ENCRYPTED(ncch)) ?
+        templates[n].keyslot = ((offs.ncch != (u64) -1) && NCCH_ENCRYPTED(ncch)) ?
             0x2C : 0xFF; // actual keyslot may be different
         templates[n].flags = VFLAG_EXEFS_FILE;
         n++;
@@ -231,7 +354,7 @@ bool BuildVGameNcchDir(void) {
 
     // header
     strncpy(templates[n].name, NAME_NCCH_HEADER, 32);
-    templates[n].offset = offset_ncch + 0;
+    templates[n].offset = offs.ncch + 0;
     templates[n].size = 0x200;
     templates[n].keyslot = 0xFF;
     templates[n].flags = VFLAG_NCCH;
@@ -240,7 +363,7 @@ bool BuildVGameNcchDir(void) {
     // extended header
     if (ncch->size_exthdr) {
         strncpy(templates[n].name, NAME_NCCH_EXTHEADER, 32);
-        templates[n].offset = offset_ncch + NCCH_EXTHDR_OFFSET;
+        templates[n].offset = offs.ncch + NCCH_EXTHDR_OFFSET;
         templates[n].size = NCCH_EXTHDR_SIZE;
         templates[n].keyslot = ncch_crypto ? 0x2C : 0xFF;
         templates[n].flags = VFLAG_EXTHDR;
@@ -250,7 +373,7 @@ bool BuildVGameNcchDir(void) {
     // plain region
     if (ncch->size_plain) {
         strncpy(templates[n].name, NAME_NCCH_PLAIN, 32);
-        templates[n].offset = offset_ncch + (ncch->offset_plain * NCCH_MEDIA_UNIT);
+        templates[n].offset = offs.ncch + (ncch->offset_plain * NCCH_MEDIA_UNIT);
         templates[n].size = ncch->size_plain * NCCH_MEDIA_UNIT;
         templates[n].keyslot = 0xFF;
         templates[n].flags = VFLAG_NCCH;
@@ -260,7 +383,7 @@ bool BuildVGameNcchDir(void) {
     // logo region
     if (ncch->size_logo) {
         strncpy(templates[n].name, NAME_NCCH_LOGO, 32);
-        templates[n].offset = offset_ncch + (ncch->offset_logo * NCCH_MEDIA_UNIT);
+        templates[n].offset = offs.ncch + (ncch->offset_logo * NCCH_MEDIA_UNIT);
         templates[n].size = ncch->size_logo * NCCH_MEDIA_UNIT;
         templates[n].keyslot = 0xFF;
         templates[n].flags = VFLAG_NCCH;
@@ -270,7 +393,7 @@ bool BuildVGameNcchDir(void) {
     // exefs
     if (ncch->size_exefs) {
         strncpy(templates[n].name, NAME_NCCH_EXEFS, 32);
-        templates[n].offset = offset_ncch + (ncch->offset_exefs * NCCH_MEDIA_UNIT);
+        templates[n].offset = offs.ncch + (ncch->offset_exefs * NCCH_MEDIA_UNIT);
         templates[n].size = ncch->size_exefs * NCCH_MEDIA_UNIT;
         templates[n].keyslot = ncch_crypto ? 0x2C : 0xFF; // real slot may be something else
         templates[n].flags = VFLAG_EXEFS;
@@ -286,7 +409,7 @@ bool BuildVGameNcchDir(void) {
     // romfs
     if (ncch->size_romfs) {
         strncpy(templates[n].name, NAME_NCCH_ROMFS, 32);
-        templates[n].offset = offset_ncch + (ncch->offset_romfs * NCCH_MEDIA_UNIT);
+        templates[n].offset = offs.ncch + (ncch->offset_romfs * NCCH_MEDIA_UNIT);
         templates[n].size = ncch->size_romfs * NCCH_MEDIA_UNIT;
         templates[n].keyslot = ncch_crypto ? 0x2C : 0xFF; // real slot may be something else
         templates[n].flags = VFLAG_ROMFS;
@@ -480,7 +603,7 @@ bool BuildVGameNdsDir(void) {
 
     // header
     strncpy(templates[n].name, NAME_NDS_HEADER, 32);
-    templates[n].offset = offset_nds + 0;
+    templates[n].offset = offs.nds + 0;
     templates[n].size = (twl->unit_code == TWL_UNITCODE_NTR) ? 0x200 : sizeof(TwlHeader);
     templates[n].keyslot = 0xFF;
     templates[n].flags = 0;
@@ -489,9 +612,9 @@ bool BuildVGameNdsDir(void) {
     // banner
     if (twl->icon_offset) {
         u16 v = 0;
-        ReadGameImageBytes(&v, offset_nds + twl->icon_offset, sizeof(u16));
+        ReadGameImageBytes(&v, offs.nds + twl->icon_offset, sizeof(u16));
         strncpy(templates[n].name, NAME_NDS_BANNER, 32);
-        templates[n].offset = offset_nds + twl->icon_offset;
+        templates[n].offset = offs.nds + twl->icon_offset;
         templates[n].size = TWLICON_SIZE_DATA(v);
         templates[n].keyslot = 0xFF;
         templates[n].flags = 0;
@@ -501,9 +624,9 @@ bool BuildVGameNdsDir(void) {
     // ARM9 section (+ ARM9 section footer)
     if (twl->arm9_size) {
         u32 f = 0;
-        ReadGameImageBytes(&f, offset_nds + twl->arm9_rom_offset + twl->arm9_size, sizeof(u32));
+        ReadGameImageBytes(&f, offs.nds + twl->arm9_rom_offset + twl->arm9_size, sizeof(u32));
         strncpy(templates[n].name, NAME_NDS_ARM9, 32);
-        templates[n].offset = offset_nds + twl->arm9_rom_offset;
+        templates[n].offset = offs.nds + twl->arm9_rom_offset;
         templates[n].size = twl->arm9_size;
         if (f == NDS_ARM9_FOOTER_MAGIC) templates[n].size += 0xC;
         templates[n].keyslot = 0xFF;
@@ -514,7 +637,7 @@ bool BuildVGameNdsDir(void) {
     // ARM9 overlay section
     if (twl->arm9_overlay_size) {
         strncpy(templates[n].name, NAME_NDS_ARM9OVL, 32);
-        templates[n].offset = offset_nds + twl->arm9_overlay_offset;
+        templates[n].offset = offs.nds + twl->arm9_overlay_offset;
         templates[n].size = twl->arm9_overlay_size;
         templates[n].keyslot = 0xFF;
         templates[n].flags = 0;
@@ -524,7 +647,7 @@ bool BuildVGameNdsDir(void) {
     // ARM9i section
     if ((twl->unit_code != TWL_UNITCODE_NTR) && (twl->arm9i_size)) {
         strncpy(templates[n].name, NAME_NDS_ARM9I, 32);
-        templates[n].offset = offset_nds + twl->arm9i_rom_offset;
+        templates[n].offset = offs.nds + twl->arm9i_rom_offset;
         templates[n].size = twl->arm9i_size;
         templates[n].keyslot = 0xFF;
         templates[n].flags = 0;
@@ -534,7 +657,7 @@ bool BuildVGameNdsDir(void) {
     // ARM7 section
     if (twl->arm7_size) {
         strncpy(templates[n].name, NAME_NDS_ARM7, 32);
-        templates[n].offset = offset_nds + twl->arm7_rom_offset;
+        templates[n].offset = offs.nds + twl->arm7_rom_offset;
         templates[n].size = twl->arm7_size;
         templates[n].keyslot = 0xFF;
         templates[n].flags = 0;
@@ -544,7 +667,7 @@ bool BuildVGameNdsDir(void) {
     // ARM7 overlay section
     if (twl->arm7_overlay_size) {
         strncpy(templates[n].name, NAME_NDS_ARM7OVL, 32);
-        templates[n].offset = offset_nds + twl->arm7_overlay_offset;
+        templates[n].offset = offs.nds + twl->arm7_overlay_offset;
         templates[n].size = twl->arm7_overlay_size;
         templates[n].keyslot = 0xFF;
         templates[n].flags = 0;
@@ -554,7 +677,7 @@ bool BuildVGameNdsDir(void) {
     // ARM7i section
     if ((twl->unit_code != TWL_UNITCODE_NTR) && (twl->arm7i_size)) {
         strncpy(templates[n].name, NAME_NDS_ARM7I, 32);
-        templates[n].offset = offset_nds + twl->arm7i_rom_offset;
+        templates[n].offset = offs.nds + twl->arm7i_rom_offset;
         templates[n].size = twl->arm7i_size;
         templates[n].keyslot = 0xFF;
         templates[n].flags = 0;
@@ -564,7 +687,7 @@ bool BuildVGameNdsDir(void) {
     // data
     if (twl->fnt_size && twl->fat_size && (twl->fnt_offset < twl->fat_offset)) {
         strncpy(templates[n].name, NAME_NDS_DATADIR, 32);
-        templates[n].offset = offset_nds + 0;
+        templates[n].offset = offs.nds + 0;
         templates[n].size = twl->ntr_rom_size;
         templates[n].keyslot = 0xFF;
         templates[n].flags = VFLAG_NITRO_DIR | VFLAG_DIR;
@@ -588,9 +711,9 @@ bool BuildVGameFirmDir(void) {
     n++;
 
     // arm9 binary (only for encrypted)
-    if (offset_a9bin != (u64) -1) {
+    if (offs.a9bin != (u64) -1) {
         strncpy(templates[n].name, NAME_FIRM_ARM9BIN, 32);
-        templates[n].offset = offset_a9bin;
+        templates[n].offset = offs.a9bin;
         templates[n].size = GetArm9BinarySize(a9l);
         templates[n].keyslot = 0x15;
         templates[n].flags = 0;
@@ -632,7 +755,7 @@ bool BuildVGameFirmDir(void) {
                 snprintf(templates[n].name, 32, NAME_FIRM_NCCH, p9_ncch.programId, name, ".app");
                 templates[n].offset = offset_p9;
                 templates[n].size = p9_ncch.size * NCCH_MEDIA_UNIT;
-                templates[n].keyslot = (offset_a9bin == (u64) -1) ? 0xFF : 0x15;
+                templates[n].keyslot = (offs.a9bin == (u64) -1) ? 0xFF : 0x15;
                 templates[n].flags = 0;
                 n++;
                 memcpy(templates + n, templates + n - 1, sizeof(VirtualFile));
@@ -739,8 +862,14 @@ bool BuildVGameTadDir(void) {
 void DeinitVGameDrive(void) {
     if (vgame_buffer) free(vgame_buffer);
     if (vgame_fs_buffer) free(vgame_fs_buffer);
+    for (u32 i = 0; i < VGAME_ROMFS_MEMO; i++) {
+        if (romfs_memo[i].fs_buffer) free(romfs_memo[i].fs_buffer);
+        romfs_memo[i].fs_buffer = NULL;
+        romfs_memo[i].offset_romfs = (u64) -1;
+    }
     vgame_buffer = NULL;
     vgame_fs_buffer = NULL;
+    ncch_memo = NULL;
 }
 
 u64 InitVGameDrive(void) { // prerequisite: game file mounted as image
@@ -749,18 +878,9 @@ u64 InitVGameDrive(void) { // prerequisite: game file mounted as image
     vgame_type = 0;
     DeinitVGameDrive();
 
-    offset_firm  = (u64) -1;
-    offset_a9bin = (u64) -1;
-    offset_cia   = (u64) -1;
-    offset_ncsd  = (u64) -1;
-    offset_ncch  = (u64) -1;
-    offset_exefs = (u64) -1;
-    offset_romfs = (u64) -1;
-    offset_lv3   = (u64) -1;
-    offset_lv3fd = (u64) -1;
-    offset_nds   = (u64) -1;
-    offset_nitro = (u64) -1;
-    offset_tad   = (u64) -1;
+    memset(&offs, 0xFF, sizeof(VGameOffsets)); // all unset
+    memset(ncch_map_offs, 0xFF, sizeof(ncch_map_offs));
+    cbc_next_block = (u64) -1;
 
     base_vdir =
         (type & SYS_FIRM  ) ? VFLAG_FIRM  :
@@ -790,6 +910,8 @@ u64 InitVGameDrive(void) { // prerequisite: game file mounted as image
     ncsd  = (NcsdHeader*)    (void*) (((u8*) vgame_buffer) + 0x2F600); // 512 byte reserved
     ncch  = (NcchHeader*)    (void*) (((u8*) vgame_buffer) + 0x2F800); // 512 byte reserved
     exefs = (ExeFsHeader*)   (void*) (((u8*) vgame_buffer) + 0x2FA00); // 512 byte reserved (1kb reserve)
+    ncch_memo = (VGameNcchMemo*) (void*) (((u8*) vgame_buffer) + 0x30000); // 8 x 3kb reserved
+    for (u32 i = 0; i < VGAME_NCCH_MEMO; i++) ncch_memo[i].offset_ncch = (u64) -1;
     // filesystem stuff (RomFS / NitroFS) and CIA/TADX will be allocated on demand
 
     vgame_type = type;
@@ -818,28 +940,28 @@ bool OpenVGameDir(VirtualDir* vdir, VirtualFile* ventry) {
 
     // CIA content special handling
     if (vdir->flags & VFLAG_CIA) { // disable content crypto
-        offset_ccnt = (u64) -1;
-        index_ccnt = (u32) -1;
+        offs.ccnt = (u64) -1;
+        offs.index_ccnt = (u32) -1;
     } else if (vdir->flags & VFLAG_CIA_CONTENT) { // enable content crypto
-        offset_ccnt = vdir->offset;
-        index_ccnt = ventry->keyslot;
+        offs.ccnt = vdir->offset;
+        offs.index_ccnt = ventry->keyslot;
     }
 
     // build directories where required
-    if ((vdir->flags & VFLAG_FIRM) && (offset_firm != vdir->offset)) {
+    if ((vdir->flags & VFLAG_FIRM) && (offs.firm != vdir->offset)) {
         if ((ReadImageBytes((u8*) firm, 0, sizeof(FirmHeader)) != 0) ||
             (ValidateFirmHeader(firm, 0) != 0)) return false;
-        offset_firm = vdir->offset;
+        offs.firm = vdir->offset;
         FirmSectionHeader* arm9s = FindFirmArm9Section(firm);
         if (arm9s && (ReadImageBytes((u8*) a9l, arm9s->offset, sizeof(FirmA9LHeader)) == 0) &&
             (ValidateFirmA9LHeader(a9l) == 0) &&
             ((SetupArm9BinaryCrypto(a9l)) == 0))
-            offset_a9bin = arm9s->offset + ARM9BIN_OFFSET;
+            offs.a9bin = arm9s->offset + ARM9BIN_OFFSET;
         if (!BuildVGameFirmDir()) return false;
-    } else if ((vdir->flags & VFLAG_TAD) && (offset_tad != vdir->offset)) {
-        offset_tad = vdir->offset; // always zero(!)
+    } else if ((vdir->flags & VFLAG_TAD) && (offs.tad != vdir->offset)) {
+        offs.tad = vdir->offset; // always zero(!)
         if (!BuildVGameTadDir()) return false;
-    } else if ((vdir->flags & VFLAG_CIA) && (offset_cia != vdir->offset)) {
+    } else if ((vdir->flags & VFLAG_CIA) && (offs.cia != vdir->offset)) {
         CiaInfo info;
         CiaStub* cia;
         u8 __attribute__((aligned(32))) hdr[0x20];
@@ -852,42 +974,43 @@ bool OpenVGameDir(VirtualDir* vdir, VirtualFile* ventry) {
             free(cia);
             return false;
         }
-        offset_cia = vdir->offset; // always zero(!)
+        offs.cia = vdir->offset; // always zero(!)
         GetTitleKey(cia_titlekey, (Ticket*)&(cia->ticket));
         if (!BuildVGameCiaDir(cia)) {
             free(cia);
             return false;
         }
         free(cia);
-    } else if ((vdir->flags & VFLAG_NCSD) && (offset_ncsd != vdir->offset)) {
+    } else if ((vdir->flags & VFLAG_NCSD) && (offs.ncsd != vdir->offset)) {
         if ((ReadImageBytes((u8*) ncsd, 0, sizeof(NcsdHeader)) != 0) ||
             (ValidateNcsdHeader(ncsd) != 0))
             return false;
-        offset_ncsd = vdir->offset; // always zero(!)
+        offs.ncsd = vdir->offset; // always zero(!)
         if (!BuildVGameNcsdDir()) return false;
-    } else if ((vdir->flags & VFLAG_NCCH) && (offset_ncch != vdir->offset)) {
-        offset_ncch = (u64) -1;
+    } else if ((vdir->flags & VFLAG_NCCH) && (offs.ncch != vdir->offset) && !RestoreVGameNcch(vdir->offset)) {
+        offs.ncch = (u64) -1;
         if ((ReadNcchImageBytes((u8*) ncch, vdir->offset, sizeof(NcchHeader)) != 0) ||
             (ValidateNcchHeader(ncch) != 0))
             return false;
-        offset_ncch = vdir->offset;
+        offs.ncch = vdir->offset;
         if (!BuildVGameNcchDir()) return false;
         if (ncch->size_exefs) {
-            u32 ncch_offset_exefs = offset_ncch + (ncch->offset_exefs * NCCH_MEDIA_UNIT);
+            u32 ncch_offset_exefs = offs.ncch + (ncch->offset_exefs * NCCH_MEDIA_UNIT);
             if ((ReadNcchImageBytes((u8*) exefs, ncch_offset_exefs, sizeof(ExeFsHeader)) != 0) ||
                 (ValidateExeFsHeader(exefs, ncch->size_exefs * NCCH_MEDIA_UNIT) != 0))
                 return false;
-            offset_exefs = ncch_offset_exefs;
+            offs.exefs = ncch_offset_exefs;
             if (!BuildVGameExeFsDir()) return false;
         }
-    } else if ((vdir->flags & VFLAG_EXEFS) && (offset_exefs != vdir->offset)) {
+        MemoVGameNcch();
+    } else if ((vdir->flags & VFLAG_EXEFS) && (offs.exefs != vdir->offset)) {
         if ((ReadNcchImageBytes((u8*) exefs, vdir->offset, sizeof(ExeFsHeader)) != 0) ||
             (ValidateExeFsHeader(exefs, ncch->size_exefs * NCCH_MEDIA_UNIT) != 0))
             return false;
-        offset_exefs = vdir->offset;
+        offs.exefs = vdir->offset;
         if (!BuildVGameExeFsDir()) return false;
-    } else if ((vdir->flags & VFLAG_ROMFS) && (offset_romfs != vdir->offset)) {
-        offset_nitro = (u64) -1; // mutually exclusive
+    } else if ((vdir->flags & VFLAG_ROMFS) && (offs.romfs != vdir->offset) && !SwitchVGameRomFs(vdir->offset)) {
+        offs.nitro = (u64) -1; // mutually exclusive
         // validate ivfc header
         RomFsIvfcHeader ivfc;
         if ((ReadNcchImageBytes(&ivfc, vdir->offset, sizeof(RomFsIvfcHeader)) != 0) ||
@@ -895,29 +1018,29 @@ bool OpenVGameDir(VirtualDir* vdir, VirtualFile* ventry) {
             return false;
         // validate lv3 header
         RomFsLv3Header lv3;
-        offset_lv3 = vdir->offset + GetRomFsLvOffset(&ivfc, 3);
-        if ((ReadNcchImageBytes(&lv3, offset_lv3, sizeof(RomFsLv3Header)) != 0) ||
+        offs.lv3 = vdir->offset + GetRomFsLvOffset(&ivfc, 3);
+        if ((ReadNcchImageBytes(&lv3, offs.lv3, sizeof(RomFsLv3Header)) != 0) ||
             (ValidateLv3Header(&lv3, 0) != 0)) {
-            offset_lv3 = (u64) -1;
+            offs.lv3 = (u64) -1;
             return false;
         }
         // set up filesystem buffer
         if (vgame_fs_buffer) free(vgame_fs_buffer);
         vgame_fs_buffer = malloc(lv3.offset_filedata);
-        if (!vgame_fs_buffer || (offset_lv3 == (u64) -1) ||
-            (ReadNcchImageBytes(vgame_fs_buffer, offset_lv3, lv3.offset_filedata) != 0))
+        if (!vgame_fs_buffer || (offs.lv3 == (u64) -1) ||
+            (ReadNcchImageBytes(vgame_fs_buffer, offs.lv3, lv3.offset_filedata) != 0))
             return false;
-        offset_lv3fd = offset_lv3 + lv3.offset_filedata;
-        offset_romfs = vdir->offset;
+        offs.lv3fd = offs.lv3 + lv3.offset_filedata;
+        offs.romfs = vdir->offset;
         BuildLv3Index(&lv3idx, vgame_fs_buffer);
-    } else if ((vdir->flags & VFLAG_NDS) && (offset_nds != vdir->offset)) {
+    } else if ((vdir->flags & VFLAG_NDS) && (offs.nds != vdir->offset)) {
         if ((ReadGameImageBytes(twl, vdir->offset, 0x200) != 0) ||
             (ValidateTwlHeader(twl) != 0))
             return false;
-        offset_nds = vdir->offset;
+        offs.nds = vdir->offset;
         if (!BuildVGameNdsDir()) return false;
-    } else if ((vdir->flags & VFLAG_NITRO_DIR) && (offset_nitro != offset_nds)) {
-        offset_romfs = (u64) -1; // mutually exclusive
+    } else if ((vdir->flags & VFLAG_NITRO_DIR) && (offs.nitro != offs.nds)) {
+        ParkVGameRomFs(); // mutually exclusive
         // sanity checks
         if (!twl->fnt_size || !twl->fat_size ||
             (twl->fnt_offset >= twl->fat_offset))
@@ -928,7 +1051,7 @@ bool OpenVGameDir(VirtualDir* vdir, VirtualFile* ventry) {
         vgame_fs_buffer = malloc(size_nitro);
         if (!vgame_fs_buffer || (ReadGameImageBytes(vgame_fs_buffer, vdir->offset + twl->fnt_offset, size_nitro) != 0))
             return false;
-        offset_nitro = offset_nds;
+        offs.nitro = offs.nds;
     }
 
     // for romfs/nitro dir: switch to lv3/nitro object
@@ -947,7 +1070,7 @@ bool OpenVGameDir(VirtualDir* vdir, VirtualFile* ventry) {
 bool ReadVGameDirLv3(VirtualFile* vfile, VirtualDir* vdir) {
     vfile->name[0] = '\0';
     vfile->flags = VFLAG_LV3 | VFLAG_READONLY;
-    vfile->keyslot = ((offset_ncch != (u64) -1) && NCCH_ENCRYPTED(ncch)) ?
+    vfile->keyslot = ((offs.ncch != (u64) -1) && NCCH_ENCRYPTED(ncch)) ?
         0x2C : 0xFF; // actual keyslot may be different
 
     // start from parent dir object
@@ -1041,7 +1164,7 @@ bool ReadVGameDirNitro(VirtualFile* vfile, VirtualDir* vdir) {
         u32 fileid = vdir->index;
         bool is_dir;
         if (ReadNitroRomEntry(&(vfile->offset), &(vfile->size), &is_dir, fileid, fnt_entry, fat) == 0) {
-            if (!is_dir) vfile->offset += offset_nds;
+            if (!is_dir) vfile->offset += offs.nds;
             vfile->offset |= ((u64)(fnt_entry - fnt)) << 32;
             if (is_dir) vfile->flags |= VFLAG_DIR;
             // advance to next entry
@@ -1101,7 +1224,7 @@ int ReadVGameFile(const VirtualFile* vfile, void* buffer, u64 offset, u64 count)
         RomFsLv3FileMeta* lv3file;
         if (vfile->flags & VFLAG_DIR) return -1;
         lv3file = LV3_GET_FILE(vfile->offset, &lv3idx);
-        vfoffset = offset_lv3fd + lv3file->offset_data;
+        vfoffset = offs.lv3fd + lv3file->offset_data;
     } else if (vfile->flags & VFLAG_NITRO) {
         vfoffset = vfile->offset & 0xFFFFFFFF;
     }
@@ -1117,7 +1240,7 @@ int ReadVGameFile(const VirtualFile* vfile, void* buffer, u64 offset, u64 count)
 bool FindVirtualFileInLv3Dir(VirtualFile* vfile, const VirtualDir* vdir, const char* name) {
     vfile->name[0] = '\0';
     vfile->flags = vdir->flags & ~VFLAG_DIR;
-    vfile->keyslot = ((offset_ncch != (u64) -1) && NCCH_ENCRYPTED(ncch)) ?
+    vfile->keyslot = ((offs.ncch != (u64) -1) && NCCH_ENCRYPTED(ncch)) ?
         0x2C : 0xFF; // actual keyslot may be different
 
     RomFsLv3DirMeta* lv3dir = GetLv3DirMeta(name, vdir->offset, &lv3idx);
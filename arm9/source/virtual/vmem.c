@@ -7,6 +7,8 @@
 #include "itcm.h"
 #include "spiflash.h"
 #include "i2c.h"
+#include "pxiqueue.h"
+#include "perf.h"
 
 #define VFLAG_CALLBACK      (1UL<<26)
 #define VFLAG_BOOT9         (1UL<<27)
@@ -42,6 +44,7 @@ enum VMemCallbackType {
     VMEM_CALLBACK_MCU_REGISTERS,
     VMEM_CALLBACK_FLASH_CID,
     VMEM_CALLBACK_NVRAM,
+    VMEM_CALLBACK_PERF,
     VMEM_NUM_CALLBACKS
 };
 
@@ -49,12 +52,14 @@ ReadVMemFileCallback ReadVMemOTPDecrypted;
 ReadVMemFileCallback ReadVMemMCURegisters;
 ReadVMemFileCallback ReadVMemFlashCID;
 ReadVMemFileCallback ReadVMemNVRAM;
+ReadVMemFileCallback ReadVMemPerf;
 
 static ReadVMemFileCallback* const vMemCallbacks[] = {
     ReadVMemOTPDecrypted,
     ReadVMemMCURegisters,
     ReadVMemFlashCID,
-    ReadVMemNVRAM
+    ReadVMemNVRAM,
+    ReadVMemPerf
 };
 STATIC_ASSERT(sizeof(vMemCallbacks) / sizeof(vMemCallbacks[0]) == VMEM_NUM_CALLBACKS);
 
@@ -82,7 +87,8 @@ static const VirtualFile vMemFileTemplates[] = {
     { "mcu_dsi_regs.mem" , VMEM_CALLBACK_MCU_REGISTERS, 0x00000100, I2C_DEV_POWER, VFLAG_CALLBACK | VFLAG_READONLY },
     { "sd_cid.mem"       , VMEM_CALLBACK_FLASH_CID    , 0x00000010, 0x00, VFLAG_CALLBACK | VFLAG_READONLY },
     { "nand_cid.mem"     , VMEM_CALLBACK_FLASH_CID    , 0x00000010, 0x01, VFLAG_CALLBACK | VFLAG_READONLY },
-    { "nvram.mem"        , VMEM_CALLBACK_NVRAM        , NVRAM_SIZE, 0x00, VFLAG_CALLBACK | VFLAG_READONLY }
+    { "nvram.mem"        , VMEM_CALLBACK_NVRAM        , NVRAM_SIZE, 0x00, VFLAG_CALLBACK | VFLAG_READONLY },
+    { "perfctr.txt"      , VMEM_CALLBACK_PERF         , PERF_REPORT_SIZE, 0x00, VFLAG_CALLBACK } // writing resets
 };
 
 bool ReadVMemDir(VirtualFile* vfile, VirtualDir* vdir) { // uses a generic vdir object generated in virtual.c
@@ -157,8 +163,12 @@ int ReadVMemFlashCID(const VirtualFile* vfile, void* buffer, u64 offset, u64 cou
 }
 
 // Read NVRAM.
+// The NVRAM is never written from here, so the whole image is read once
+// and served from memory for the rest of the session.
 int ReadVMemNVRAM(const VirtualFile* vfile, void* buffer, u64 offset, u64 count) {
     static bool wififlash_initialized = false;
+    static u8* nvram_cache_buf = NULL;
+    static u8* nvram_cache = NULL;
     (void) vfile;
 
     if (!wififlash_initialized) {
@@ -166,11 +176,39 @@ int ReadVMemNVRAM(const VirtualFile* vfile, void* buffer, u64 offset, u64 count)
         if (!wififlash_initialized) return 1;
     }
 
+    if (!nvram_cache) {
+        nvram_cache_buf = (u8*) malloc(NVRAM_SIZE + PXIQ_LINE_SIZE);
+        if (nvram_cache_buf) { // line aligned, so the ARM11 can fill it directly
+            u8* cache = (u8*) align((u32) nvram_cache_buf, PXIQ_LINE_SIZE);
+            if (spiflash_read(0, NVRAM_SIZE, cache)) nvram_cache = cache;
+            else {
+                free(nvram_cache_buf);
+                nvram_cache_buf = NULL;
+            }
+        }
+    }
+
+    if (nvram_cache) {
+        memcpy(buffer, nvram_cache + offset, count);
+        return 0;
+    }
+
     if (!spiflash_read((u32) offset, (u32) count, buffer))
         return 1;
     return 0;
 }
 
+// Read performance counters.
+int ReadVMemPerf(const VirtualFile* vfile, void* buffer, u64 offset, u64 count) {
+    static char report[PERF_REPORT_SIZE];
+    (void) vfile;
+
+    // new snapshot whenever reading starts from the top
+    if (!offset) PerfReport(report);
+    memcpy(buffer, report + offset, count);
+    return 0;
+}
+
 int ReadVMemFile(const VirtualFile* vfile, void* buffer, u64 offset, u64 count) {
     if (vfile->flags & VFLAG_CALLBACK) {
         if ((offset + count > vfile->size) || (0u + offset + count < offset))
@@ -184,7 +222,10 @@ int ReadVMemFile(const VirtualFile* vfile, void* buffer, u64 offset, u64 count)
 }
 
 int WriteVMemFile(const VirtualFile* vfile, const void* buffer, u64 offset, u64 count) {
-    if (vfile->flags & (VFLAG_READONLY|VFLAG_CALLBACK)) {
+    if ((vfile->flags & VFLAG_CALLBACK) && (vfile->offset == VMEM_CALLBACK_PERF)) {
+        PerfReset(); // any write resets the performance counters
+        return 0;
+    } else if (vfile->flags & (VFLAG_READONLY|VFLAG_CALLBACK)) {
         return 1; // not writable / writes blocked
     } else {
         u32 foffset = vfile->offset + offset;
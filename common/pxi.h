@@ -38,6 +38,9 @@ enum {
 	PXICMD_SET_NOTIFY_LED,
 	PXICMD_SET_BRIGHTNESS,
 
+	PXICMD_JOB_SUBMIT,
+	PXICMD_CMDQ_KICK,
+
 	PXICMD_NONE,
 };
 
@@ -21,6 +21,45 @@
 #include <arm.h>
 
 #define SHMEM_BUFFER_SIZE 2048
+#define SHMEM_JOB_SLOTS   8
+#define SHMEM_CMD_SLOTS   16
+#define SHMEM_CMD_ARGS    4
+
+// job slot states, a slot is owned by the ARM9 while FREE or DONE
+// and by the ARM11 while QUEUED or RUNNING
+enum {
+	SHMEM_JOB_FREE = 0,
+	SHMEM_JOB_QUEUED,
+	SHMEM_JOB_RUNNING,
+	SHMEM_JOB_DONE,
+};
+
+// available ARM11 job kernels
+enum {
+	SHMEM_KERNEL_CRC32 = 0,
+
+	SHMEM_KERNEL_COUNT,
+};
+
+typedef struct {
+	u32 status;
+	u32 kernel;
+	u32 src;
+	u32 len;
+	u32 arg;
+	u32 result;
+} __attribute__((packed, aligned(4))) SystemJob;
+
+// queued PXI command descriptor, if buf is set it replaces
+// the shared data buffer for the duration of the command
+typedef struct {
+	u32 cmd;
+	u32 argc;
+	u32 args[SHMEM_CMD_ARGS];
+	u32 buf;
+	u32 len;
+	u32 reply;
+} __attribute__((packed, aligned(4))) SystemCmd;
 
 typedef struct {
 	union {
@@ -34,6 +73,13 @@ typedef struct {
 		uint32_t w[SHMEM_BUFFER_SIZE / 4];
 		uint64_t q[SHMEM_BUFFER_SIZE / 8];
 	} dataBuffer;
+
+	SystemJob jobRing[SHMEM_JOB_SLOTS];
+
+	// cmdHead is only written by the ARM9, cmdDone only by the ARM11
+	// both count up, descriptors are at cmdRing[n % SHMEM_CMD_SLOTS]
+	u32 cmdHead, cmdDone;
+	SystemCmd cmdRing[SHMEM_CMD_SLOTS];
 } __attribute__((packed, aligned(8))) SystemSHMEM;
 
 #ifdef ARM9
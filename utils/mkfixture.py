@@ -0,0 +1,688 @@
+""" Generate synthetic, structurally valid NCCH / NCSD / CIA / NAND / title.db / ticket.db images for benchmarking. """
+import argparse as _argparse
+import hashlib as _hashlib
+import os as _os
+import random as _random
+import struct as _struct
+import sys as _sys
+
+MEDIA_UNIT = 0x200
+IVFC_BLOCK_LOG = 12 # 0x1000 byte hash blocks on all levels
+IVFC_BLOCK = 1 << IVFC_BLOCK_LOG
+IVFC_HEADER_SIZE = 0x60
+EXTHDR_SIZE = 0x800 # hashed: first 0x400 only
+NCSD_NCCH_OFFSET = 0x4000
+CIA_HEADER_SIZE = 0x2020
+CIA_CERT_SIZE = 0xA00
+TMD_SIZE_BASE = 0xB04
+TMD_CHUNK_SIZE = 0x30
+TICKET_BASE_SIZE = 0x2A4
+LV3_NONE = 0xFFFFFFFF
+
+# NAND layout as on retail consoles (in sectors), xorpads dumped from the X: drive only fit this
+NAND_SIZE = {False: 0x1D7800, True: 0x26C000}
+NAND_CTR_SECTOR = 0x05C980
+NAND_TWL_FAT = ((0x000097, 0x047DA9), (0x04808D, 0x0105B3)) # twln, twlp
+NAND_CTR_FAT = {False: (0x000165, 0x179F1B), True: (0x000157, 0x20E969)}
+FAT16_ROOT_ENTRIES = 0x200
+FAT_DATE = ((2020 - 1980) << 9) | (1 << 5) | 1
+
+# DIFF geometry, keep in sync with TICKDB_MAGIC in arm9/source/game/ticketdb.h
+DIFF_OFFSET_TABLE1 = 0x200
+DIFF_OFFSET_TABLE0 = 0x430
+DIFF_SIZE_HASH = 0x120
+DIFF_OFFSET_PARTITION = 0x800
+DPFS_LOG_LVL2 = 7
+TICKDB_SIZE_PARTITION = 0x0237EE00
+BDRI_BLOCK = 0x80
+BDRI_SPARE_ENTRIES = 64 # room for entries added on the console
+
+# keep in sync with arm9/source/game/tmd.h and ticket.h
+TMD_ISSUER = b"Root-CA00000003-CP0000000b"
+TICKET_ISSUER = b"Root-CA00000003-XS0000000c"
+SIG_TYPE_RSA2048_SHA256 = b"\x00\x01\x00\x04"
+
+
+def _exit_fatal(msg):
+    """ Print an error message to stderr and exit. """
+    print("Fatal: {0}".format(msg), file=_sys.stderr)
+
+    exit(1)
+
+
+def _align(value, alignment):
+    """ Align value up to a multiple of alignment. """
+    return (value + alignment - 1) // alignment * alignment
+
+
+def _size(text):
+    """ Parse a size with an optional K / M / G suffix. """
+    mult = {"K": 1 << 10, "M": 1 << 20, "G": 1 << 30}.get(text[-1:].upper(), 1)
+    return int(text[:-1] if mult > 1 else text, 0) * mult
+
+
+def _lv3_hash(wname, offset_parent):
+    """ Same as HashLv3Path() in arm9/source/game/romfs.c. """
+    value = offset_parent ^ 123456789
+    for i in range(0, len(wname), 2):
+        value = (((value >> 5) | (value << 27)) & 0xFFFFFFFF) ^ (wname[i] | (wname[i + 1] << 8))
+    return value
+
+
+def _bucket_count(n_entries):
+    """ Number of hash buckets for n entries (any odd number works for lookup). """
+    return max(3, n_entries | 1)
+
+
+class RandomData:
+    """ Deterministic filler data, generated in chunks. """
+    def __init__(self, seed):
+        self.rng = _random.Random(seed)
+
+    def read(self, size):
+        """ Return the next size bytes. """
+        return self.rng.getrandbits(size * 8).to_bytes(size, "little") if size else b""
+
+
+class HashWriter:
+    """ Writes to a file while hashing each IVFC block, and keeps the hashes. """
+    def __init__(self, out):
+        self.out = out
+        self.block = bytearray()
+        self.hashes = bytearray()
+
+    def write(self, data):
+        """ Write and hash data. """
+        if self.out:
+            self.out.write(data)
+        self.block += data
+        while len(self.block) >= IVFC_BLOCK:
+            self.hashes += _hashlib.sha256(self.block[:IVFC_BLOCK]).digest()
+            del self.block[:IVFC_BLOCK]
+
+    def finish(self):
+        """ Pad the last block with zeroes and return all block hashes. """
+        if self.block:
+            self.write(bytes(IVFC_BLOCK - len(self.block)))
+        return bytes(self.hashes)
+
+
+def _block_hashes(data):
+    """ Return the IVFC block hashes of data, zero padded. """
+    hasher = HashWriter(None)
+    hasher.write(data)
+    return hasher.finish()
+
+
+def build_lv3(n_files, n_dirs, file_size):
+    """ Build RomFS level 3 metadata. Returns (metadata, [(data offset, size)], data size). """
+    # directories: root first, then n_dirs subdirectories
+    dirs = [{"name": b"", "parent": 0, "files": []}]
+    for i in range(n_dirs):
+        dirs.append({"name": "dir{0:03d}".format(i).encode("utf-16le"), "parent": 0, "files": []})
+    files = []
+    for i in range(n_files):
+        parent = dirs[1 + (i % n_dirs)] if n_dirs else dirs[0]
+        entry = {"name": "file{0:06d}.bin".format(i).encode("utf-16le"), "size": file_size}
+        parent["files"].append(entry)
+        files.append(entry)
+
+    # offsets of dir / file meta entries
+    offset = 0
+    for entry in dirs:
+        entry["offset"] = offset
+        offset += 0x18 + _align(len(entry["name"]), 4)
+    size_dirmeta = offset
+    offset = 0
+    data_offset = 0
+    for entry in dirs:
+        for fentry in entry["files"]:
+            fentry["offset"] = offset
+            fentry["parent"] = entry["offset"]
+            fentry["data"] = data_offset
+            offset += 0x20 + _align(len(fentry["name"]), 4)
+            data_offset += _align(fentry["size"], 0x10)
+    size_filemeta = offset
+
+    # hash tables
+    dirhash = [LV3_NONE] * _bucket_count(len(dirs))
+    dir_samehash = {}
+    for entry in dirs:
+        bucket = _lv3_hash(entry["name"], entry["parent"]) % len(dirhash)
+        dir_samehash[entry["offset"]] = dirhash[bucket]
+        dirhash[bucket] = entry["offset"]
+    filehash = [LV3_NONE] * _bucket_count(len(files))
+    file_samehash = {}
+    for entry in files:
+        bucket = _lv3_hash(entry["name"], entry["parent"]) % len(filehash)
+        file_samehash[entry["offset"]] = filehash[bucket]
+        filehash[bucket] = entry["offset"]
+
+    # directory metadata
+    dirmeta = bytearray()
+    subdirs = dirs[1:]
+    for i, entry in enumerate(dirs):
+        if i == 0:
+            sibling = LV3_NONE
+            child = subdirs[0]["offset"] if subdirs else LV3_NONE
+        else:
+            sibling = dirs[i + 1]["offset"] if i + 1 < len(dirs) else LV3_NONE
+            child = LV3_NONE
+        first_file = entry["files"][0]["offset"] if entry["files"] else LV3_NONE
+        dirmeta += _struct.pack("<6I", entry["parent"], sibling, child, first_file,
+                                dir_samehash[entry["offset"]], len(entry["name"]))
+        dirmeta += entry["name"].ljust(_align(len(entry["name"]), 4), b"\0")
+
+    # file metadata
+    filemeta = bytearray()
+    for entry in dirs:
+        for i, fentry in enumerate(entry["files"]):
+            sibling = entry["files"][i + 1]["offset"] if i + 1 < len(entry["files"]) else LV3_NONE
+            filemeta += _struct.pack("<IIQQII", fentry["parent"], sibling, fentry["data"], fentry["size"],
+                                     file_samehash[fentry["offset"]], len(fentry["name"]))
+            filemeta += fentry["name"].ljust(_align(len(fentry["name"]), 4), b"\0")
+
+    # level 3 header + tables
+    offset_dirhash = 0x28
+    offset_dirmeta = offset_dirhash + (len(dirhash) * 4)
+    offset_filehash = offset_dirmeta + size_dirmeta
+    offset_filemeta = offset_filehash + (len(filehash) * 4)
+    offset_filedata = _align(offset_filemeta + size_filemeta, 0x10)
+    meta = bytearray(_struct.pack("<10I", 0x28, offset_dirhash, len(dirhash) * 4, offset_dirmeta, size_dirmeta,
+                                  offset_filehash, len(filehash) * 4, offset_filemeta, size_filemeta, offset_filedata))
+    meta += _struct.pack("<{0}I".format(len(dirhash)), *dirhash) + dirmeta
+    meta += _struct.pack("<{0}I".format(len(filehash)), *filehash) + filemeta
+    meta += bytes(offset_filedata - len(meta))
+    files.sort(key=lambda x: x["data"])
+    return bytes(meta), [(fentry["data"], fentry["size"]) for fentry in files], data_offset
+
+
+def write_romfs(out, args, rnd):
+    """ Write a complete RomFS (IVFC) at the current position. Returns (size, hashed size). """
+    n_files = max(1, args.files)
+    file_size = max(1, args.size // n_files)
+    meta, files, size_filedata = build_lv3(n_files, args.dirs, file_size)
+    size_lvl3 = len(meta) + size_filedata
+    size_lvl2 = _align(size_lvl3, IVFC_BLOCK) // IVFC_BLOCK * 0x20
+    size_lvl1 = _align(size_lvl2, IVFC_BLOCK) // IVFC_BLOCK * 0x20
+    size_master = _align(size_lvl1, IVFC_BLOCK) // IVFC_BLOCK * 0x20
+    offset_lvl3 = _align(IVFC_HEADER_SIZE + size_master, IVFC_BLOCK)
+
+    start = out.tell()
+    out.write(bytes(offset_lvl3))
+
+    # level 3: metadata and file data, hashed on the fly
+    lvl3 = HashWriter(out)
+    lvl3.write(meta)
+    for _, size in files:
+        pad = _align(size, 0x10) - size
+        while size:
+            chunk = min(size, 1 << 20)
+            lvl3.write(rnd.read(chunk))
+            size -= chunk
+        lvl3.write(bytes(pad))
+    lvl2_data = lvl3.finish()
+
+    # level 2 hashes level 3, level 1 hashes level 2, master hashes level 1
+    # order in file (see GetRomFsLvOffset()): level 3, level 1, level 2
+    lvl1_data = _block_hashes(lvl2_data)
+    master = _block_hashes(lvl1_data)
+    out.write(lvl1_data.ljust(_align(size_lvl1, IVFC_BLOCK), b"\0"))
+    out.write(lvl2_data.ljust(_align(size_lvl2, IVFC_BLOCK), b"\0"))
+    end = out.tell()
+
+    # IVFC header and master hash
+    header = _struct.pack("<8sIQQI4xQQI4xQQI4xII4x", b"IVFC\x00\x00\x01\x00", size_master,
+                          0, size_lvl1, IVFC_BLOCK_LOG,
+                          _align(size_lvl1, IVFC_BLOCK), size_lvl2, IVFC_BLOCK_LOG,
+                          _align(size_lvl1, IVFC_BLOCK) + _align(size_lvl2, IVFC_BLOCK), size_lvl3, IVFC_BLOCK_LOG,
+                          0x5C, 0)
+    out.seek(start)
+    out.write(header + master)
+    out.seek(end)
+
+    size = _align(end - start, MEDIA_UNIT)
+    out.write(bytes(size - (end - start)))
+    return size, _align(IVFC_HEADER_SIZE + size_master, MEDIA_UNIT)
+
+
+def write_exefs(out, args, rnd):
+    """ Write an ExeFS at the current position. Returns the size. """
+    files = [(b".code", rnd.read(args.code_size)),
+             (b"banner", rnd.read(0x1000)),
+             (b"icon", b"SMDH" + bytes(0x36C0 - 4))]
+    table = bytearray()
+    hashes = [bytes(0x20)] * 10
+    data = bytearray()
+    for i, (name, content) in enumerate(files):
+        table += _struct.pack("<8sII", name, len(data), len(content))
+        hashes[9 - i] = _hashlib.sha256(content).digest()
+        data += content.ljust(_align(len(content), MEDIA_UNIT), b"\0")
+    table = table.ljust(0xA0 + 0x20, b"\0") + b"".join(hashes)
+    out.write(table + data)
+    return len(table) + len(data)
+
+
+def write_ncch(out, args):
+    """ Write a NoCrypto CXI at the current position. Returns its size. """
+    rnd = RandomData(args.seed)
+    start = out.tell()
+    out.write(bytes(MEDIA_UNIT))
+
+    exthdr = bytearray(EXTHDR_SIZE)
+    exthdr[0:8] = b"FIXTURE\0"
+    exthdr[0x200:0x208] = _struct.pack("<Q", args.title_id) # ACI title id
+    out.write(exthdr)
+
+    offset_exefs = out.tell() - start
+    size_exefs = write_exefs(out, args, rnd)
+    offset_romfs = out.tell() - start
+    size_romfs, size_romfs_hash = write_romfs(out, args, rnd)
+    size = out.tell() - start
+
+    # hashes of the hashed regions
+    out.seek(start + offset_exefs)
+    hash_exefs = _hashlib.sha256(out.read(MEDIA_UNIT)).digest()
+    out.seek(start + offset_romfs)
+    hash_romfs = _hashlib.sha256(out.read(size_romfs_hash)).digest()
+
+    flags = bytes([0, 0, 0, 0x00, 0x01, 0x03, 0x00, 0x04]) # CTR, CXI (data + executable), NoCrypto
+    header = bytearray(b"\xFF" * 0x100)
+    header += _struct.pack("<4sIQ2sHIQ16x32x16s", b"NCCH", size // MEDIA_UNIT, args.title_id, b"00", 2, 0,
+                           args.title_id, b"CTR-P-GMFX")
+    header += _hashlib.sha256(bytes(exthdr[:0x400])).digest()
+    header += _struct.pack("<I4x8s", 0x400, flags)
+    header += _struct.pack("<IIIIIII4xIII4x", 0, 0, 0, 0, offset_exefs // MEDIA_UNIT, size_exefs // MEDIA_UNIT, 1,
+                           offset_romfs // MEDIA_UNIT, size_romfs // MEDIA_UNIT, size_romfs_hash // MEDIA_UNIT)
+    header += hash_exefs + hash_romfs
+    out.seek(start)
+    out.write(header.ljust(MEDIA_UNIT, b"\0"))
+    out.seek(start + size)
+    return size
+
+
+def write_ncsd(out, args):
+    """ Write a NCSD (.3DS) with a single CXI partition. """
+    out.write(bytes(NCSD_NCCH_OFFSET))
+    size = write_ncch(out, args)
+    header = bytearray(b"\xFF" * 0x100)
+    header += _struct.pack("<4sIQ8x8x", b"NCSD", (NCSD_NCCH_OFFSET + size) // MEDIA_UNIT, args.title_id)
+    header += _struct.pack("<II", NCSD_NCCH_OFFSET // MEDIA_UNIT, size // MEDIA_UNIT) + bytes(7 * 8)
+    header += bytes(0x20 + 4 + 4 + 8) + _struct.pack("<Q", args.title_id)
+    out.seek(0)
+    out.write(header.ljust(MEDIA_UNIT, b"\0"))
+
+
+def _sha256_region(out, offset, size):
+    """ Hash a region of the output file. """
+    sha = _hashlib.sha256()
+    out.seek(offset)
+    while size:
+        data = out.read(min(size, 1 << 20))
+        sha.update(data)
+        size -= len(data)
+    return sha.digest()
+
+
+def build_ticket(title_id, n_rights):
+    """ Build a ticket, same as BuildVariableFakeTicket(). """
+    size_cnt_index = 0x28 + (n_rights * 0x84)
+    ticket = bytearray(TICKET_BASE_SIZE)
+    ticket[0:4] = SIG_TYPE_RSA2048_SHA256
+    ticket[4:0x104] = b"\xFF" * 0x100
+    ticket[0x140:0x180] = TICKET_ISSUER.ljust(0x40, b"\0")
+    ticket[0x180:0x1BC] = b"\xFF" * 0x3C
+    ticket[0x1BC] = 0x01 # version
+    ticket[0x1BF:0x1CF] = b"\xFF" * 0x10 # titlekey (content is unencrypted)
+    ticket[0x1DC:0x1E4] = _struct.pack(">Q", title_id)
+    ticket[0x1F1] = 0x00 # common key index
+    ticket[0x221] = 0x01 # audit
+    cnt_index = bytearray(size_cnt_index)
+    cnt_index[0:0x14] = _struct.pack(">HHIIHHI", 1, 0x14, size_cnt_index, 0x14, 1, 0x14, 0)
+    cnt_index[0x14:0x28] = _struct.pack(">IIIIHH", 0x28, n_rights, 0x84, 0x84 * n_rights, 3, 0)
+    for i in range(n_rights):
+        cnt_index[0x28 + (i * 0x84):0x2C + (i * 0x84)] = _struct.pack(">HH", 0, 1024 * i)
+        cnt_index[0x2C + (i * 0x84):0xAC + (i * 0x84)] = b"\xFF" * 0x80
+    return bytes(ticket + cnt_index)
+
+
+def write_cia(out, args):
+    """ Write a CIA with a single (unencrypted) CXI content and a fake ticket / TMD. """
+    n_rights = (args.max_contents + 1023) >> 10
+    size_ticket = TICKET_BASE_SIZE + 0x28 + (n_rights * 0x84)
+    size_tmd = TMD_SIZE_BASE + TMD_CHUNK_SIZE
+    offset_cert = _align(CIA_HEADER_SIZE, 64)
+    offset_ticket = offset_cert + _align(CIA_CERT_SIZE, 64)
+    offset_tmd = offset_ticket + _align(size_ticket, 64)
+    offset_content = offset_tmd + _align(size_tmd, 64)
+
+    out.write(bytes(offset_content))
+    size = write_ncch(out, args)
+    hash_content = _sha256_region(out, offset_content, size)
+
+    # header: content index 0 present
+    header = _struct.pack("<IHHIIIIQ", CIA_HEADER_SIZE, 0, 0, CIA_CERT_SIZE, size_ticket, size_tmd, 0, size)
+    header += b"\x80" + bytes(0x2000 - 1)
+
+    ticket = build_ticket(args.title_id, n_rights)
+
+    # TMD, same as BuildFakeTmd() + FixTmdHashes()
+    chunk = _struct.pack(">IHHQ", 0, 0, 0, size) + hash_content
+    tmd = bytearray(TMD_SIZE_BASE)
+    tmd[0:4] = SIG_TYPE_RSA2048_SHA256
+    tmd[4:0x104] = b"\xFF" * 0x100
+    tmd[0x140:0x180] = TMD_ISSUER.ljust(0x40, b"\0")
+    tmd[0x180] = 0x01 # version
+    tmd[0x18C:0x194] = _struct.pack(">Q", args.title_id)
+    tmd[0x197] = 0x40 # title type
+    tmd[0x1DE:0x1E0] = _struct.pack(">H", 1) # content count
+    tmd[0x204:0x208] = _struct.pack(">HH", 0, 1) # content info 0: index 0, 1 content
+    tmd[0x208:0x228] = _hashlib.sha256(chunk).digest()
+    tmd[0x1E4:0x204] = _hashlib.sha256(bytes(tmd[0x204:0xB04])).digest()
+    tmd += chunk
+
+    out.seek(0)
+    out.write(header)
+    out.seek(offset_ticket)
+    out.write(ticket)
+    out.seek(offset_tmd)
+    out.write(tmd)
+
+
+def _fat_dir_entry(name, attr, cluster, size):
+    """ Build a FAT directory entry (8.3 name, no LFN). """
+    return _struct.pack("<11sB8xHHHHI", name, attr, 0, 0, FAT_DATE, cluster, size)
+
+
+def write_fat16(out, offset, count, hidden, label, rnd, n_files=0, file_size=0, n_dirs=0):
+    """ Format a FAT16 volume of count sectors at offset, files are spread over subdirectories. """
+    spc = 8
+    while count // spc > 0xFF00:
+        spc *= 2
+    root_sectors = FAT16_ROOT_ENTRIES * 0x20 // MEDIA_UNIT
+    fat_sectors = _align((count // spc + 2) * 2, MEDIA_UNIT) // MEDIA_UNIT
+    n_clusters = (count - 1 - (2 * fat_sectors) - root_sectors) // spc
+    if not 4085 <= n_clusters <= 65524:
+        _exit_fatal("bad FAT16 cluster count")
+    if n_dirs >= FAT16_ROOT_ENTRIES:
+        _exit_fatal("too many dirs")
+    cluster_size = spc * MEDIA_UNIT
+    offset_fat = offset + MEDIA_UNIT
+    offset_root = offset_fat + (2 * fat_sectors * MEDIA_UNIT)
+    offset_data = offset_root + (root_sectors * MEDIA_UNIT)
+
+    fat = [0xFFF8, 0xFFFF]
+    def alloc(size):
+        """ Allocate a contiguous cluster chain, returns the first cluster. """
+        first = len(fat)
+        n = max(1, _align(size, cluster_size) // cluster_size)
+        if first + n > n_clusters + 2:
+            _exit_fatal("files don't fit into the FAT partition")
+        fat.extend(range(first + 1, first + n))
+        fat.append(0xFFFF)
+        return first
+
+    # directories first, then their files (contiguous)
+    root = [_fat_dir_entry(label, 0x08, 0, 0)]
+    n_dirs_used = max(1, n_dirs) if n_files else 0
+    for d in range(n_dirs_used):
+        name = "DIR{0:05d}".format(d) if n_dirs else "FIXTURE"
+        n_dir_files = len(range(d, n_files, n_dirs_used))
+        cluster = alloc((n_dir_files + 2) * 0x20)
+        root.append(_fat_dir_entry(name.ljust(11).encode(), 0x10, cluster, 0))
+        entries = [_fat_dir_entry(b".".ljust(11), 0x10, cluster, 0), _fat_dir_entry(b"..".ljust(11), 0x10, 0, 0)]
+        for i in range(d, n_files, n_dirs_used):
+            fcluster = alloc(file_size)
+            entries.append(_fat_dir_entry("F{0:07d}BIN".format(i).encode(), 0x20, fcluster, file_size))
+            out.seek(offset_data + ((fcluster - 2) * cluster_size))
+            size = file_size
+            while size:
+                chunk = min(size, 1 << 20)
+                out.write(rnd.read(chunk))
+                size -= chunk
+        out.seek(offset_data + ((cluster - 2) * cluster_size))
+        out.write(b"".join(entries))
+    out.seek(offset_root)
+    out.write(b"".join(root))
+
+    # FAT (both copies) and boot sector
+    fat_data = _struct.pack("<{0}H".format(len(fat)), *fat)
+    for i in range(2):
+        out.seek(offset_fat + (i * fat_sectors * MEDIA_UNIT))
+        out.write(fat_data)
+    boot = _struct.pack("<3s8sHBHBHHBHHHII", b"\xEB\x3C\x90", b"GM9FIXTR", MEDIA_UNIT, spc, 1, 2, FAT16_ROOT_ENTRIES,
+                        count if count < 0x10000 else 0, 0xF8, fat_sectors, 0x3F, 0xFF, hidden,
+                        count if count >= 0x10000 else 0)
+    boot += _struct.pack("<BBBI11s8s", 0x80, 0, 0x29, int.from_bytes(rnd.read(4), "little"), label, b"FAT16   ")
+    out.seek(offset)
+    out.write(boot.ljust(0x1FE, b"\0") + b"\x55\xAA")
+
+
+def _mbr_partitions(partitions):
+    """ Build the MBR partition table (+ magic) for up to four FAT16 partitions. """
+    table = bytearray()
+    for sector, count in partitions:
+        table += _struct.pack("<B3sB3sII", 0x00, b"\x01\x01\x00", 0x06, b"\xFE\xFF\xFF", sector, count)
+    return bytes(table.ljust(0x40, b"\0")) + b"\x55\xAA"
+
+
+def _xor_region(out, offset, size, path):
+    """ Encrypt a region of the output in place with a xorpad file. """
+    if not _os.path.isfile(path) or _os.path.getsize(path) != size:
+        _exit_fatal("{0} missing or wrong size (need 0x{1:X} bytes)".format(path, size))
+    with open(path, "rb") as pad:
+        pos = 0
+        while pos < size:
+            chunk = min(size - pos, 1 << 20)
+            out.seek(offset + pos)
+            data = int.from_bytes(out.read(chunk).ljust(chunk, b"\0"), "little")
+            out.seek(offset + pos)
+            out.write((data ^ int.from_bytes(pad.read(chunk), "little")).to_bytes(chunk, "little"))
+            pos += chunk
+
+
+def write_nand(out, args):
+    """ Write a NAND image (NCSD header, TWL / CTR FAT16 partitions, AGBSAVE, FIRM0 / FIRM1). """
+    rnd = RandomData(args.seed)
+    n3ds = args.n3ds
+    nand_size = NAND_SIZE[n3ds]
+    ctr_fat = NAND_CTR_FAT[n3ds]
+    # (name, fs type, crypto type, sector, count), see NP_TYPE_ and NP_SUBTYPE_ in arm9/source/nand/nand.h
+    partitions = [("twl", 1, 1, 0x000000, 0x058800),
+                  ("agbsave.bin", 4, 2, 0x058800, 0x000180),
+                  ("firm0.bin", 3, 2, 0x058980, 0x002000),
+                  ("firm1.bin", 3, 2, 0x05A980, 0x002000),
+                  ("ctrnand_full.bin", 1, 3 if n3ds else 2, NAND_CTR_SECTOR, nand_size - NAND_CTR_SECTOR)]
+    out.truncate(nand_size * MEDIA_UNIT)
+
+    # NCSD header, its last 0x42 byte are the (TWL encrypted) TWL MBR
+    header = bytearray(b"\xFF" * 0x100)
+    header += _struct.pack("<4sIQ", b"NCSD", nand_size, 0)
+    header += bytes(p[1] for p in partitions).ljust(8, b"\0") + bytes(p[2] for p in partitions).ljust(8, b"\0")
+    header += b"".join(_struct.pack("<II", p[3], p[4]) for p in partitions).ljust(8 * 8, b"\0")
+    header = header.ljust(0x1BE, b"\0") + _mbr_partitions(NAND_TWL_FAT)
+    out.seek(0)
+    out.write(header)
+
+    # FAT partitions, file data goes to CTRNAND
+    n_files = max(1, args.files)
+    write_fat16(out, NAND_TWL_FAT[0][0] * MEDIA_UNIT, NAND_TWL_FAT[0][1], NAND_TWL_FAT[0][0], b"TWLN       ", rnd)
+    write_fat16(out, NAND_TWL_FAT[1][0] * MEDIA_UNIT, NAND_TWL_FAT[1][1], NAND_TWL_FAT[1][0], b"TWLP       ", rnd)
+    out.seek(NAND_CTR_SECTOR * MEDIA_UNIT)
+    out.write(bytes(0x1BE) + _mbr_partitions([ctr_fat]))
+    write_fat16(out, (NAND_CTR_SECTOR + ctr_fat[0]) * MEDIA_UNIT, ctr_fat[1], ctr_fat[0], b"CTRNAND    ", rnd,
+                n_files, max(1, args.size // n_files), args.dirs)
+
+    # encryption is console unique, only possible with that console's xorpads
+    if args.xorpads:
+        pads = [("twlmbr.bin", 0x1BE, 0x42),
+                ("twln.bin", NAND_TWL_FAT[0][0] * MEDIA_UNIT, NAND_TWL_FAT[0][1] * MEDIA_UNIT),
+                ("twlp.bin", NAND_TWL_FAT[1][0] * MEDIA_UNIT, NAND_TWL_FAT[1][1] * MEDIA_UNIT)]
+        pads += [(p[0], p[3] * MEDIA_UNIT, p[4] * MEDIA_UNIT) for p in partitions[1:]]
+        for name, offset, size in pads:
+            _xor_region(out, offset, size, _os.path.join(args.xorpads, name + ".xorpad"))
+
+
+def _bdri_hash(tid, parent, bucket_count):
+    """ Same as GetHashBucket() in arm9/source/game/bdri.c. """
+    value = parent ^ 0x091A2B3C
+    for i in range(2):
+        value = ((value >> 1) | (value << 31)) & 0xFFFFFFFF
+        value ^= _struct.unpack_from("<I", tid, i * 4)[0]
+    return value % bucket_count
+
+
+def _bdri_fat_node(fat, first, last):
+    """ Mark data blocks first ... last as a single FAT node (first in its chain). """
+    i, j = first + 1, last + 1
+    fat[i] = (0x80000000, 0x80000000 if j > i else 0)
+    if j > i:
+        fat[i + 1] = fat[j] = (i | 0x80000000, j)
+
+
+def build_bdri(entries, tickdb):
+    """ Build a BDRI image (title.db / ticket.db IVFC lvl4) from [(title id, entry data)]. """
+    pre_header = _struct.pack("<4sIII", b"TICK", 1, 0, 0) if tickdb else b"NANDTDB".ljust(0x80, b"\0")
+    entry_blocks = _align(max(len(data) for _, data in entries), BDRI_BLOCK) // BDRI_BLOCK
+    max_files = len(entries) + BDRI_SPARE_ENTRIES
+    fht_count = _bucket_count(max_files)
+    det_blocks = 1 # dummy + root dir entry
+    fet_blocks = _align((max_files + 1) * 0x2C, BDRI_BLOCK) // BDRI_BLOCK
+    n_blocks = det_blocks + fet_blocks + (max_files * entry_blocks)
+
+    # tables, offsets relative to the fs header
+    offset_dht = 0x88
+    offset_fht = offset_dht + (3 * 4)
+    offset_fat = offset_fht + (fht_count * 4)
+    offset_data = _align(len(pre_header) + offset_fat + ((n_blocks + 1) * 8), BDRI_BLOCK) - len(pre_header)
+    image_size = len(pre_header) + offset_data + (n_blocks * BDRI_BLOCK)
+
+    # file entries, hash buckets, data
+    fht = [0] * fht_count
+    fet = bytearray(_struct.pack("<II32xI", len(entries) + 1, max_files + 1, 0))
+    data = bytearray()
+    fat = [(0, 0)] * (n_blocks + 1)
+    _bdri_fat_node(fat, 0, det_blocks - 1)
+    _bdri_fat_node(fat, det_blocks, det_blocks + fet_blocks - 1)
+    block = det_blocks + fet_blocks
+    for i, (title_id, content) in enumerate(entries, 1):
+        tid = _struct.pack("<Q", title_id)
+        bucket = _bdri_hash(tid, 1, fht_count)
+        size_blocks = _align(len(content), BDRI_BLOCK) // BDRI_BLOCK
+        fet += _struct.pack("<I8sI4xIQ8xI", 1, tid, i + 1 if i < len(entries) else 0, block, len(content), fht[bucket])
+        fht[bucket] = i
+        _bdri_fat_node(fat, block, block + size_blocks - 1)
+        data += content.ljust(size_blocks * BDRI_BLOCK, b"\0")
+        block += size_blocks
+    if block < n_blocks: # single free node for the rest
+        _bdri_fat_node(fat, block, n_blocks - 1)
+        fat[0] = (0, block + 1)
+    det = _struct.pack("<II24x", 2, 2) + _struct.pack("<IIII16x", 0, 0, 0, 1 if entries else 0)
+
+    fs_header = _struct.pack("<4sIQQI4x4sIQI4xQI4xQI4xQI4xIII4xIII4x", b"BDRI", 0x30000, 0x20,
+                             image_size // BDRI_BLOCK, BDRI_BLOCK, bytes(4), BDRI_BLOCK, offset_dht, 3,
+                             offset_fht, fht_count, offset_fat, n_blocks, offset_data, n_blocks,
+                             0, det_blocks, 1, det_blocks, fet_blocks, max_files)
+    image = bytearray(pre_header + fs_header)
+    image += bytes(len(pre_header) + offset_fht - len(image))
+    image += _struct.pack("<{0}I".format(fht_count), *fht)
+    image += b"".join(_struct.pack("<II", u, v) for u, v in fat)
+    image += bytes(len(pre_header) + offset_data - len(image))
+    image += det.ljust(det_blocks * BDRI_BLOCK, b"\0") + fet.ljust(fet_blocks * BDRI_BLOCK, b"\0") + data
+    return bytes(image.ljust(image_size, b"\0"))
+
+
+def write_diff(out, lvl4, size_partition=0):
+    """ Write a DIFF container with lvl4 as external IVFC lvl4 (CMAC is left zero). """
+    # IVFC lvl1 - lvl3 (hashes) go to DPFS lvl3, master hash goes to the DIFI table
+    lvl3 = _block_hashes(lvl4)
+    lvl2 = _block_hashes(lvl3)
+    lvl1 = _block_hashes(lvl2)
+    master = _block_hashes(lvl1)
+    if len(master) > DIFF_SIZE_HASH:
+        _exit_fatal("too much data for the DIFF container")
+    offset_ivfc = (0, _align(len(lvl1), IVFC_BLOCK), _align(len(lvl1), IVFC_BLOCK) + _align(len(lvl2), IVFC_BLOCK))
+    ivfc_data = lvl1.ljust(offset_ivfc[1], b"\0") + lvl2.ljust(offset_ivfc[2] - offset_ivfc[1], b"\0") + lvl3
+
+    # DPFS: all selector bits zero, only the first copy of each level is in use
+    size_dpfs3 = _align(len(ivfc_data), IVFC_BLOCK)
+    size_dpfs2 = max(4, _align(size_dpfs3 >> IVFC_BLOCK_LOG, 32) // 8)
+    size_dpfs1 = max(4, _align(_align(size_dpfs2, 1 << DPFS_LOG_LVL2) >> DPFS_LOG_LVL2, 32) // 8)
+    offset_dpfs2 = _align(2 * size_dpfs1, IVFC_BLOCK)
+    offset_dpfs3 = offset_dpfs2 + _align(2 * size_dpfs2, IVFC_BLOCK)
+    offset_lvl4 = offset_dpfs3 + (2 * size_dpfs3)
+    size_min = offset_lvl4 + _align(len(lvl4), IVFC_BLOCK)
+    if size_partition and size_partition < size_min:
+        _exit_fatal("too much data for the DIFF container")
+    size_partition = size_partition or size_min
+
+    difi = _struct.pack("<8sQQQQQQBB2xQ", b"DIFI\x00\x00\x01\x00", 0x44, 0x78, 0xBC, 0x50, 0x10C, DIFF_SIZE_HASH,
+                        1, 0, offset_lvl4)
+    ivfc = _struct.pack("<8sQQQI4xQQI4xQQI4xQQQQ", b"IVFC\x00\x00\x02\x00", DIFF_SIZE_HASH,
+                        offset_ivfc[0], len(lvl1), IVFC_BLOCK_LOG, offset_ivfc[1], len(lvl2), IVFC_BLOCK_LOG,
+                        offset_ivfc[2], len(lvl3), IVFC_BLOCK_LOG, size_dpfs3, len(lvl4), IVFC_BLOCK_LOG, 0x78)
+    dpfs = _struct.pack("<8sQQI4xQQI4xQQI4x", b"DPFS\x00\x00\x01\x00", 0, size_dpfs1, 0,
+                        offset_dpfs2, size_dpfs2, DPFS_LOG_LVL2, offset_dpfs3, size_dpfs3, IVFC_BLOCK_LOG)
+    table = difi + ivfc + dpfs + master.ljust(DIFF_SIZE_HASH, b"\0")
+    header = _struct.pack("<8sQQQQQI32sQ", b"DIFF\x00\x00\x03\x00", DIFF_OFFSET_TABLE1, DIFF_OFFSET_TABLE0,
+                          len(table), DIFF_OFFSET_PARTITION, size_partition, 1, _hashlib.sha256(table).digest(), 0)
+
+    out.truncate(DIFF_OFFSET_PARTITION + size_partition)
+    out.seek(0x100)
+    out.write(header)
+    for offset in (DIFF_OFFSET_TABLE1, DIFF_OFFSET_TABLE0):
+        out.seek(offset)
+        out.write(table)
+    out.seek(DIFF_OFFSET_PARTITION + offset_dpfs3)
+    out.write(ivfc_data)
+    out.seek(DIFF_OFFSET_PARTITION + offset_lvl4)
+    out.write(lvl4)
+
+
+def write_titledb(out, args):
+    """ Write a title.db with args.files title info entries. """
+    entries = []
+    for i in range(args.files):
+        title_id = args.title_id + (i << 8)
+        tie = _struct.pack("<QII4xII4xI4x8x16s12xI4x44x", args.size, 0x40, 0, 0, 0, 0,
+                           "CTR-P-{0:04X}".format(i & 0xFFFF).encode(), 0)
+        entries.append((title_id, tie))
+    write_diff(out, build_bdri(entries, False))
+
+
+def write_ticketdb(out, args):
+    """ Write a ticket.db with args.files tickets. """
+    entries = []
+    for i in range(args.files):
+        title_id = args.title_id + (i << 8)
+        ticket = build_ticket(title_id, 1)
+        entries.append((title_id, _struct.pack("<II", 1, len(ticket)) + ticket))
+    write_diff(out, build_bdri(entries, True), TICKDB_SIZE_PARTITION)
+
+
+def main():
+    """ Entry point. """
+    parser = _argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("type", choices=["ncch", "ncsd", "cia", "nand", "titledb", "ticketdb"],
+                        help="type of image to generate")
+    parser.add_argument("output", help="output file")
+    parser.add_argument("-s", "--size", type=_size, default=_size("16M"), help="total RomFS / CTRNAND file data (K/M/G)")
+    parser.add_argument("-n", "--files", type=int, default=64, help="number of RomFS / CTRNAND files or db entries")
+    parser.add_argument("-d", "--dirs", type=int, default=0, help="spread files over this many dirs")
+    parser.add_argument("-c", "--code-size", type=_size, default=_size("1M"), help="size of .code (K/M/G)")
+    parser.add_argument("-t", "--title-id", type=lambda x: int(x, 16), default=0x000400000FF3F000)
+    parser.add_argument("--seed", type=int, default=0, help="seed for the filler data")
+    parser.add_argument("--max-contents", type=int, default=1024, help="TITLE_MAX_CONTENTS of the build")
+    parser.add_argument("--n3ds", action="store_true", help="New 3DS NAND layout")
+    parser.add_argument("--xorpads", help="encrypt NAND with xorpads from this dir (dumped from X: on the console)")
+    args = parser.parse_args()
+    if args.files < 1 or args.dirs < 0:
+        _exit_fatal("need at least one file")
+
+    with open(args.output, "w+b") as out:
+        {"ncch": write_ncch, "ncsd": write_ncsd, "cia": write_cia, "nand": write_nand,
+         "titledb": write_titledb, "ticketdb": write_ticketdb}[args.type](out, args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,78 @@
+""" Map a GodMode9 profile (gm9/out/profile.bin) to the functions of arm9.elf. """
+import argparse as _argparse
+import bisect as _bisect
+import struct as _struct
+import sys as _sys
+
+HEADER = _struct.Struct("<4s9I")
+
+
+def _exit_fatal(msg):
+    """ Print an error message to stderr and exit. """
+    print("Fatal: {0}".format(msg), file=_sys.stderr)
+
+    exit(1)
+
+
+def load_symbols(fname):
+    """ Return a sorted list of (address, size, name) for all ELF32 functions. """
+    with open(fname, "rb") as f: # pylint: disable=invalid-name
+        elf = f.read()
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 1:
+        _exit_fatal("{0} is not a little endian ELF32 file".format(fname))
+
+    shoff, = _struct.unpack_from("<I", elf, 0x20)
+    shentsize, shnum = _struct.unpack_from("<HH", elf, 0x2E)
+    sections = [_struct.unpack_from("<10I", elf, shoff + (i * shentsize)) for i in range(shnum)]
+
+    funcs = []
+    for sec in sections:
+        if sec[1] != 2: # SHT_SYMTAB
+            continue
+        strtab = sections[sec[6]]
+        for off in range(sec[4], sec[4] + sec[5], 16):
+            name, value, size, info = _struct.unpack_from("<IIIB", elf, off)
+            if (info & 0xF) != 2: # STT_FUNC
+                continue
+            name_off = strtab[4] + name
+            name = elf[name_off:elf.index(b"\0", name_off)].decode("ascii", "replace")
+            funcs.append((value & ~1, size, name)) # strip the thumb bit
+    funcs.sort()
+    return funcs
+
+
+def main():
+    """ Entry point. """
+    parser = _argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("profile", help="profile.bin file")
+    parser.add_argument("elf", help="arm9.elf of the exact same build")
+    parser.add_argument("-n", type=int, default=30, help="number of functions to show")
+    args = parser.parse_args()
+
+    with open(args.profile, "rb") as f: # pylint: disable=invalid-name
+        data = f.read()
+    hdr = HEADER.unpack_from(data)
+    magic, version, text_start, _, shift, n_buckets, n_samples, n_outside, _, _ = hdr
+    if magic != b"GM9P" or version != 1:
+        _exit_fatal("not a GodMode9 profile (v1)")
+    buckets = _struct.unpack_from("<{0}I".format(n_buckets), data, HEADER.size)
+
+    funcs = load_symbols(args.elf)
+    addrs = [func[0] for func in funcs]
+    hits = {}
+    for i, count in enumerate(buckets):
+        if not count:
+            continue
+        addr = text_start + (i << shift)
+        idx = _bisect.bisect_right(addrs, addr) - 1
+        name = funcs[idx][2] if idx >= 0 else "?"
+        hits[name] = hits.get(name, 0) + count
+
+    total = max(n_samples, 1)
+    print("# {0} samples, {1} outside of .text".format(n_samples, n_outside))
+    for name, count in sorted(hits.items(), key=lambda x: -x[1])[:args.n]:
+        print("{0:6.2f}% {1:8d} {2}".format(100.0 * count / total, count, name))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,74 @@
+""" Decode a GodMode9 trace file (gm9/out/trace.bin). """
+import argparse as _argparse
+import struct as _struct
+import sys as _sys
+
+# keep in sync with arm9/source/common/trace.h
+EVENTS = [
+    "none",
+    "fs_open",
+    "fs_rename",
+    "fs_unlink",
+    "fs_mkdir",
+    "aes_keyx",
+    "aes_keyy",
+    "aes_key",
+    "aes_use",
+    "mount",
+    "unmount",
+    "img_mount",
+    "script_start",
+    "script_end",
+    "flush",
+]
+
+HEADER = _struct.Struct("<4sIIIQQ")
+RECORD = _struct.Struct("<QIII20s")
+
+
+def _exit_fatal(msg):
+    """ Print an error message to stderr and exit. """
+    print("Fatal: {0}".format(msg), file=_sys.stderr)
+
+    exit(1)
+
+
+def decode(data):
+    """ Yield (seconds, event name, arg0, arg1, text) for each record. """
+    if len(data) < HEADER.size:
+        _exit_fatal("file too small")
+
+    magic, version, rec_size, n_records, tps, n_events = HEADER.unpack_from(data)
+    if magic != b"GM9T" or version != 1 or rec_size != RECORD.size:
+        _exit_fatal("not a GodMode9 trace file (v1)")
+    if n_events > n_records:
+        print("# {0} older events were overwritten".format(n_events - n_records))
+
+    t0 = None
+    for i in range(n_records):
+        off = HEADER.size + (i * rec_size)
+        if off + rec_size > len(data):
+            _exit_fatal("truncated at record {0}".format(i))
+        ticks, event, arg0, arg1, text = RECORD.unpack_from(data, off)
+        if t0 is None:
+            t0 = ticks
+        name = EVENTS[event] if event < len(EVENTS) else "event_{0}".format(event)
+        text = text.split(b"\0", 1)[0].decode("utf-8", "replace")
+        yield (ticks - t0) / tps, name, arg0, arg1, text
+
+
+def main():
+    """ Entry point. """
+    parser = _argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("trace", help="trace.bin file")
+    args = parser.parse_args()
+
+    with open(args.trace, "rb") as f: # pylint: disable=invalid-name
+        data = f.read()
+
+    for secs, name, arg0, arg1, text in decode(data):
+        print("{0:12.6f} {1:<13} {2:08X} {3:08X} {4}".format(secs, name, arg0, arg1, text))
+
+
+if __name__ == "__main__":
+    main()